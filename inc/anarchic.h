@@ -9,13 +9,42 @@
 #ifndef __AKINGDOM_H__
 #define __AKINGDOM_H__
 
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <limits.h>
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
 
-/** @const BARONIES is the number of baronies in the game */
+/** @const BARONIES is the number of baronies in the classic game */
 #define BARONIES 8
 
+/**
+ * @const MAX_BARONIES is the most baronies a game can have. A game
+ * is a single block of memory, which a 16-bit build cannot make
+ * larger than 64K, so such a build holds fewer baronies.
+ */
+#if INT_MAX > 32767
+#define MAX_BARONIES 32767
+#else
+#define MAX_BARONIES 64
+#endif
+
+/** @const ATTACKS_PER_BARONY is the attack capacity per barony */
+#define ATTACKS_PER_BARONY 8
+
+/** @const TURNS is the number of turns in the game */
+#define TURNS 12
+
+/*
+ * The constants from here on are the stock rules. A game can be
+ * played to others by giving it a ruleset (see rules.h).
+ */
+
 /** @const POPULATION_PER_GOLD is 1/ the income per population */
 #define POPULATION_PER_GOLD 1
 
@@ -37,4 +66,22 @@
 #define FOOTMEN_TAX 1
 #define FOOTMEN_PER_TAX 5
 
+/** @const KNIGHT_VALUE is the worth of a knight in footmen */
+#define KNIGHT_VALUE 10
+
+/** @const CASTLE_VALUE is the worth of a castle in footmen */
+#define CASTLE_VALUE 100
+
+/** @const MAX_GOLD is the most gold a barony can hold */
+#define MAX_GOLD 32000
+
+/** @const MAX_CASTLES is the most castles a barony can hold */
+#define MAX_CASTLES 320
+
+/** @const MAX_KNIGHTS is the most knights a barony can hold */
+#define MAX_KNIGHTS 3200
+
+/** @const MAX_FOOTMEN is the most footmen a barony can hold */
+#define MAX_FOOTMEN 32000
+
 #endif
@@ -0,0 +1,75 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Arena Allocator Header.
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stddef.h>
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct arena arena_t;
+
+/**
+ * @struct arena is a bump-pointer allocator.
+ * Objects are carved from one block in turn and are all released
+ * together when the arena is reset.
+ */
+struct arena {
+
+    /** @var memory is the block that objects are carved from. */
+    char *memory;
+
+    /** @var size is the size of the block in bytes. */
+    size_t size;
+
+    /** @var used is the number of bytes handed out so far. */
+    size_t used;
+
+};
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Initialise an arena with a block of memory.
+ * @param arena is the arena to initialise.
+ * @param size is the size of the block to reserve.
+ */
+void init_arena (arena_t *arena, size_t size);
+
+/**
+ * Allocate an object from an arena.
+ * @param arena is the arena to allocate from.
+ * @param size is the size of the object.
+ * @return a pointer to the object.
+ */
+void *arena_alloc (arena_t *arena, size_t size);
+
+/**
+ * Release every object in an arena at once.
+ * @param arena is the arena to reset.
+ */
+void reset_arena (arena_t *arena);
+
+/**
+ * Free the memory block of an arena.
+ * @param arena is the arena to free.
+ */
+void free_arena (arena_t *arena);
+
+#endif
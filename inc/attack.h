@@ -9,22 +9,50 @@
 #ifndef __ATTACK_H__
 #define __ATTACK_H__
 
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* main header required for some constant definitions */
+#include "anarchic.h"
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
 
 /* typedefs */
 typedef struct attack attack_t;
-typedef struct barony barony_t;
+typedef struct game game_t;
+
+/**
+ * @def DENSE_ATTACKS says whether a game holds its attacks densely.
+ * A game of no more than BARONIES baronies keeps each attack in a
+ * fixed place in the pool, marked by a bit in an occupancy mask.
+ * Larger games chain each barony's attacks in order of target.
+ */
+#define DENSE_ATTACKS(game) ((game)->barony_count <= BARONIES)
+
+/** @def DENSE_ATTACK is the bit number and pool place of an attack. */
+#define DENSE_ATTACK(o, t) ((o) * BARONIES + (t))
 
-/** @struct attack is the data for a single attack. */
+/** @def ATTACK_BIT is the bit for an attack in the occupancy mask. */
+#define ATTACK_BIT(o, t) (1ULL << DENSE_ATTACK (o, t))
+
+/** @def ATTACK_ROW are the mask bits for attacks from one barony. */
+#define ATTACK_ROW(o) \
+    (((1ULL << BARONIES) - 1) << ((o) * BARONIES))
+
+/**
+ * @struct attack is the data for a single attack.
+ * Attacks are held by value in the game's attack pool.
+ */
 struct attack {
 
-    /** @var origin is the origin of the attack. */
-    barony_t *origin;
+    /** @var origin is the barony originating the attack. */
+    int origin;
 
-    /** @var target is the target of the attack. */
-    barony_t *target;
+    /** @var target is the target barony. */
+    int target;
 
     /** @var knights is the number of knights sent. */
     int knights;
@@ -32,6 +60,12 @@ struct attack {
     /** @var footmen is the number of footmen sent. */
     int footmen;
 
+    /** @var next is the origin's next attack if chained, or -1. */
+    int next;
+
+    /** @var inbound is the target's next attacker this turn, or -1. */
+    int inbound;
+
 };
 
 /*----------------------------------------------------------------------
@@ -39,10 +73,54 @@ struct attack {
  */
 
 /**
- * Create a new attack.
- * @return a pointer to the attack.
+ * Create or replace an attack.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ * @param knights is the number of knights sent.
+ * @param footmen is the number of footmen sent.
+ * @return a pointer to the attack, or NULL if the pool is full.
+ */
+attack_t *new_attack (game_t *game, int o, int t, int knights,
+		      int footmen);
+
+/**
+ * Get an attack if there is one.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ * @return a pointer to the attack, or NULL if there is none.
+ */
+attack_t *get_attack (game_t *game, int o, int t);
+
+/**
+ * Cancel an attack.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ */
+void cancel_attack (game_t *game, int o, int t);
+
+/**
+ * Cancel all attacks.
+ * The state hash is left alone: the caller accounts for any attacks
+ * that were still in it.
+ * @param game is the game in progress.
+ */
+void clear_attacks (game_t *game);
+
+/**
+ * Find the lowest attack in an occupancy mask.
+ * @param mask is a non-zero occupancy mask.
+ * @return the bit number of the lowest attack.
+ */
+int lowest_attack (unsigned long long int mask);
+
+/**
+ * Find the highest attack in an occupancy mask.
+ * @param mask is a non-zero occupancy mask.
+ * @return the bit number of the highest attack.
  */
-attack_t *new_attack (barony_t *origin, barony_t *target, int knights,
-		     int footmen);
+int highest_attack (unsigned long long int mask);
 
 #endif
@@ -13,6 +13,12 @@
  * Data Definitions.
  */
 
+/**
+ * @const NAME_LENGTH is the longest name a barony can have, long
+ * enough for "Barony" and any barony number.
+ */
+#define NAME_LENGTH 12
+
 /** @enum control_t enumerates who can control a barony. */
 typedef enum {
     CONTROL_HUMAN,
@@ -20,12 +26,27 @@ typedef enum {
     CONTROL_REMOTE
 } control_t;
 
+/**
+ * @enum barony_field_t enumerates the barony fields that change in
+ * play, so that they can be visited in turn.
+ */
+typedef enum {
+    FIELD_LAND,
+    FIELD_POPULATION,
+    FIELD_GOLD,
+    FIELD_CASTLES,
+    FIELD_KNIGHTS,
+    FIELD_FOOTMEN,
+    FIELD_RANKING,
+    BARONY_FIELDS /* the number of changing fields */
+} barony_field_t;
+
 /** @struct barony is the barony structure. */
 typedef struct barony barony_t;
 struct barony {
 
     /** @var name is the name of the barony. */
-    char name[11];
+    char name[NAME_LENGTH + 1];
 
     /** @var control is who controls the barony */
     control_t control;
@@ -58,10 +79,18 @@ struct barony {
  */
 
 /**
- * Create an intialise a new barony.
+ * Initialise a barony held by value in a game.
+ * @param barony is the barony to initialise.
  * @param name is a name for the barony.
- * @return a pointer to the new barony.
  */
-barony_t *new_barony (char *name);
+void init_barony (barony_t *barony, char *name);
+
+/**
+ * Get one of the fields of a barony that change in play.
+ * @param barony is the barony.
+ * @param field is the field wanted.
+ * @return a pointer to the field.
+ */
+int *barony_field (barony_t *barony, barony_field_t field);
 
 #endif
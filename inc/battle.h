@@ -0,0 +1,121 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Battle Header.
+ */
+
+#ifndef __BATTLE_H__
+#define __BATTLE_H__
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @enum battle_math_t enumerates the arithmetic used for battles. */
+typedef enum {
+    MATH_INTEGER, /* integers only, the same on every compiler */
+    MATH_FLOAT /* floating point, as in the original game */
+} battle_math_t;
+
+/* typedefs */
+typedef struct battle battle_t;
+typedef struct attack_report attack_report_t;
+typedef struct ruleset ruleset_t;
+
+/**
+ * @struct battle is a battle at one barony: the attacking forces and
+ * the defender going in, and the outcome coming out. When several
+ * baronies attack the same target, the forces are their totals, and
+ * share_battle divides the outcome among them.
+ */
+struct battle {
+
+    /** @var knights is the total of attacking knights. */
+    unsigned long int knights;
+
+    /** @var footmen is the total of attacking footmen. */
+    unsigned long int footmen;
+
+    /** @var castles is the number of castles defending. */
+    unsigned long int castles;
+
+    /** @var defenders is the number of footmen defending. */
+    unsigned long int defenders;
+
+    /** @var land is the defender's land. */
+    unsigned long int land;
+
+    /** @var gold is the defender's gold. */
+    unsigned long int gold;
+
+    /** @var attack is the total attacking force value. */
+    unsigned long int attack;
+
+    /** @var land_taken is the amount of land taken. */
+    unsigned long int land_taken;
+
+    /** @var gold_looted is the amount of gold looted. */
+    unsigned long int gold_looted;
+
+    /** @var castles_taken is the number of castles taken. */
+    unsigned long int castles_taken;
+
+    /** @var castles_razed is the number of castles razed. */
+    unsigned long int castles_razed;
+
+    /** @var footmen_slain is the number of defending footmen slain. */
+    unsigned long int footmen_slain;
+
+    /** @var knights_lost is the number of attacking knights lost. */
+    unsigned long int knights_lost;
+
+    /** @var footmen_lost is the number of attacking footmen lost. */
+    unsigned long int footmen_lost;
+
+};
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Predict the outcome of a battle.
+ * Nothing is allocated and nothing but the battle is changed, so
+ * this is safe to call on hypothetical forces at any time.
+ * @param battle holds the forces and the defender, and receives the
+ * outcome; an outcome with no attacking force is all zeros.
+ * @param math is the battle arithmetic.
+ * @param rules are the rules of the game, or NULL for the stock rules.
+ * @return 1 if battle was joined, 0 if there was no attacking force.
+ */
+int predict_battle (battle_t *battle, battle_math_t math,
+		    ruleset_t *rules);
+
+/**
+ * Predict the outcomes of many battles at once.
+ * The arithmetic is chosen once for the whole array, and the loop
+ * calls nothing, so the compiler is free to vectorise it.
+ * @param battles are the battles, as for predict_battle.
+ * @param count is the number of battles.
+ * @param math is the battle arithmetic.
+ * @param rules are the rules of the game, or NULL for the stock rules.
+ */
+void predict_battles (battle_t *battles, int count, battle_math_t math,
+		      ruleset_t *rules);
+
+/**
+ * Work out one attacker's share of the outcome of a battle.
+ * @param share receives the gains and losses of the attacker.
+ * @param battle is the outcome of a battle that was joined.
+ * @param knights is the number of knights the attacker sent.
+ * @param footmen is the number of footmen the attacker sent.
+ * @param math is the battle arithmetic.
+ * @param rules are the rules of the game, or NULL for the stock rules.
+ */
+void share_battle (attack_report_t *share, battle_t *battle,
+		   int knights, int footmen, battle_math_t math,
+		   ruleset_t *rules);
+
+#endif
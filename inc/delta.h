@@ -0,0 +1,171 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Delta Header.
+ */
+
+#ifndef __DELTA_H__
+#define __DELTA_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* main project header */
+#include "anarchic.h"
+
+/* components recorded in a delta */
+#include "game.h"
+#include "barony.h"
+#include "order.h"
+#include "attack.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct delta delta_t;
+
+/** @enum delta_mark_t marks what a delta has of a barony. */
+typedef enum {
+    MARK_BARONY = 1, /* the barony before the turn */
+    MARK_ORIGIN = 2 /* the barony's attack chain and commitments */
+} delta_mark_t;
+
+/**
+ * @struct delta is a record of what one turn changed in a game.
+ * A delta is made for a game, and can record any of its turns in
+ * turn. The turn records each change as it makes it, so recording
+ * and undoing the turn cost what the turn changed, not the size of
+ * the game.
+ */
+struct delta {
+
+    /** @var barony_count is the number of baronies it can record. */
+    int barony_count;
+
+    /** @var attack_capacity is the number of attacks it can record. */
+    int attack_capacity;
+
+    /** @var scalars are the game's scalars before the turn. */
+    game_t scalars;
+
+    /** @var marks say what has been recorded of each barony. */
+    int *marks;
+
+    /** @var changed are the baronies changed, in the order changed. */
+    int *changed;
+
+    /** @var change_count is the number of baronies changed. */
+    int change_count;
+
+    /** @var baronies are the changed baronies before the turn. */
+    barony_t *baronies;
+
+    /** @var rank_low is the first place in the rankings changed. */
+    int rank_low;
+
+    /** @var ranks are the old ranks from that place on. */
+    rank_t *ranks;
+
+    /** @var order_baronies are the baronies whose orders were spent. */
+    int *order_baronies;
+
+    /** @var orders are the spent orders. */
+    order_t *orders;
+
+    /** @var order_count is the number of orders spent. */
+    int order_count;
+
+    /** @var attack_places are the pool places of the spent attacks. */
+    int *attack_places;
+
+    /** @var attacks are the spent attacks. */
+    attack_t *attacks;
+
+    /** @var attack_count is the number of attacks spent. */
+    int attack_count;
+
+    /**
+     * @var origins are the baronies that had attacks: for each, its
+     * number, its first chained attack and its committed knights and
+     * footmen.
+     */
+    int *origins;
+
+    /** @var origin_count is the number of baronies that had attacks. */
+    int origin_count;
+
+};
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Create a delta to record the turns of a game.
+ * @param game is the game whose turns are to be recorded.
+ * @return the new delta.
+ */
+delta_t *new_delta (game_t *game);
+
+/**
+ * Process a single turn, recording what it changes.
+ * @param game is the game to process.
+ * @param delta is a delta made for the game, to record the turn.
+ */
+void process_turn_delta (game_t *game, delta_t *delta);
+
+/**
+ * Undo the turn recorded in a delta.
+ * The game is restored as it was before the turn. Its reports still
+ * describe the turn undone, until the next turn is processed.
+ * @param game is the game that processed the turn.
+ * @param delta is the delta that recorded it.
+ */
+void undo_turn (game_t *game, delta_t *delta);
+
+/**
+ * Record a barony about to be changed by the turn being recorded.
+ * Only the first record of a barony in a turn is kept.
+ * @param delta is the delta recording the turn.
+ * @param b is the barony.
+ * @param before is the barony as it is before the change.
+ */
+void record_barony (delta_t *delta, int b, barony_t *before);
+
+/**
+ * Record an order about to be spent by the turn being recorded.
+ * @param delta is the delta recording the turn.
+ * @param b is the barony that placed the order.
+ * @param order is the order.
+ */
+void record_order (delta_t *delta, int b, order_t *order);
+
+/**
+ * Record an attack about to be spent by the turn being recorded,
+ * and the attack chain and commitments of its origin.
+ * @param delta is the delta recording the turn.
+ * @param game is the game.
+ * @param a is the attack's place in the pool.
+ */
+void record_attack (delta_t *delta, game_t *game, int a);
+
+/**
+ * Record the rankings about to be changed by the turn being recorded.
+ * @param delta is the delta recording the turn.
+ * @param game is the game.
+ * @param low is the first place to be changed.
+ */
+void record_ranks (delta_t *delta, game_t *game, int low);
+
+/**
+ * Destroy a delta when it is no longer needed.
+ * @param delta is the delta to destroy.
+ */
+void end_delta (delta_t *delta);
+
+#endif
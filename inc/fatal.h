@@ -22,6 +22,7 @@ typedef enum {
     FATAL_DISPLAY, /* cannot open display */
     FATAL_CONFIG, /* config file missing or invalid */
     FATAL_EXPIRED, /* beta has expired */
+    FATAL_HASH, /* state hash is inconsistent */
     FATAL_LAST /* placeholder */
 } fatal_t;
 
@@ -16,34 +16,211 @@
 /* main project header */
 #include "anarchic.h"
 
+/* components held within the game */
+#include "random.h"
+#include "attack.h"
+#include "arena.h"
+#include "report.h"
+#include "hash.h"
+#include "battle.h"
+#include "stats.h"
+#include "observer.h"
+#include "rules.h"
+#include "workers.h"
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
 
 /* type definitions */
 typedef struct game game_t;
+typedef struct rank rank_t;
 typedef struct barony barony_t;
 typedef struct attack attack_t;
 typedef struct order order_t;
 typedef struct report report_t;
+typedef struct candidate candidate_t;
+typedef struct summary summary_t;
+typedef struct economy economy_t;
+typedef struct front front_t;
+typedef struct delta delta_t;
+
+/** @struct rank is one place in the rankings. */
+struct rank {
+
+    /** @var barony is the barony in this place. */
+    int barony;
+
+    /** @var land is the barony's land when it was ranked. */
+    int land;
 
-/** @struct game is the data for a single game. */
+};
+
+/**
+ * @struct candidate is an order and a set of attacks that a barony
+ * might place, to be tried by evaluate_candidates.
+ */
+struct candidate {
+
+    /** @var order is the order to place, or NULL to place none. */
+    order_t *order;
+
+    /**
+     * @var attacks are the attacks to make, in order of target and no
+     * more than one on each; their origins are not looked at.
+     */
+    attack_t *attacks;
+
+    /** @var attack_count is the number of attacks. */
+    int attack_count;
+
+};
+
+/** @struct summary is the state of a barony after a turn. */
+struct summary {
+
+    /** @var land is the land owned by the barony. */
+    int land;
+
+    /** @var population is the population of the barony. */
+    int population;
+
+    /** @var gold is the barony's gold riches. */
+    int gold;
+
+    /** @var castles is the number of castles in the barony. */
+    int castles;
+
+    /** @var knights is the barony's force of knights. */
+    int knights;
+
+    /** @var footmen is the barony's army of footmen. */
+    int footmen;
+
+};
+
+/**
+ * @struct game is the data for a single game.
+ * A game is one block of memory: this structure, then its tables.
+ * The game state is the scalars before the baronies field and the
+ * state tables, which hold no pointers; the rest is working space
+ * for processing a turn. So a game is copied by copying the state,
+ * and a copy needs no memory beyond its own block and arena.
+ */
 struct game {
 
     /** @var turn is the turn number. */
     int turn;
 
-    /** @var baronies are the baronies in the game. */
-    barony_t *baronies[BARONIES];
+    /** @var seed is the seed the game was started with. */
+    unsigned long int seed;
 
-    /** @var attacks are the attacks for a turn. */
-    attack_t *attacks[BARONIES][BARONIES];
+    /** @var rng is the game's own random number generator. */
+    random_t rng;
+
+    /** @var barony_count is the number of baronies in the game. */
+    int barony_count;
+
+    /** @var attack_capacity is the number of records in the pool. */
+    int attack_capacity;
+
+    /** @var attack_mask marks the active attacks in a dense pool. */
+    unsigned long long int attack_mask;
+
+    /** @var attacks_used is the number of chained records taken. */
+    int attacks_used;
+
+    /** @var free_attack is the first cancelled record, or -1. */
+    int free_attack;
+
+    /** @var land_changed is set when rankings need to be revised. */
+    int land_changed;
+
+    /** @var report_policy says which baronies get reports. */
+    report_policy_t report_policy;
+
+    /** @var battle_math is the arithmetic for battles and desertion. */
+    battle_math_t battle_math;
+
+    /** @var hashing is 1 if the state hash is kept, 0 if not. */
+    int hashing;
+
+    /** @var hash is the state hash, revised as the state changes. */
+    hash_t hash;
+
+    /** @var rules are the rules the game is played to. */
+    ruleset_t rules;
+
+    /** @var custom_rules is 1 if the rules are not the stock ones. */
+    int custom_rules;
+
+    /** @var baronies are the baronies, the first state table. */
+    barony_t *baronies;
 
     /** @var orders are the build/recruit orders for a turn. */
-    order_t *orders[BARONIES];
+    order_t *orders;
+
+    /** @var attacks is the pool of attack records for a turn. */
+    attack_t *attacks;
+
+    /** @var first_attack is each barony's first chained attack. */
+    int *first_attack;
+
+    /** @var committed_knights are each barony's knights in attacks. */
+    int *committed_knights;
+
+    /** @var committed_footmen are each barony's footmen in attacks. */
+    int *committed_footmen;
+
+    /** @var ranks are the baronies in ranking order. */
+    rank_t *ranks;
+
+    /** @var first_inbound is each barony's first attacker, or -1. */
+    int *first_inbound;
+
+    /** @var reranks is working space for reranking baronies. */
+    rank_t *reranks;
+
+    /** @var shares are each attack's share of its battle. */
+    attack_report_t *shares;
+
+    /** @var outcomes are the battles at each barony. */
+    battle_t *outcomes;
+
+    /** @var economies are each barony's economic results. */
+    economy_t *economies;
+
+    /** @var fronts are the targets of candidates' attacks. */
+    front_t *fronts;
+
+    /** @var slots are each barony's place among the fronts. */
+    int *slots;
+
+    /** @var inbound are the attacks on a barony with candidates. */
+    attack_t *inbound;
+
+    /** @var battles are the battle records for each attack record. */
+    attack_report_t **battles;
 
     /** @var reports are the reports for each barony. */
-    report_t *reports[BARONIES];
+    report_t **reports;
+
+    /** @var arena holds all report objects for the current turn. */
+    arena_t arena;
+
+    /** @var observer is told of the results of turns, or is NULL. */
+    observer_t *observer;
+
+    /** @var workers share out the work of a turn, or are NULL. */
+    workers_t *workers;
+
+    /** @var delta records the turn in progress, or is NULL. */
+    delta_t *delta;
+
+#ifdef GAME_STATS
+    /** @var stats are the calls to and time in each stage of a turn. */
+    game_stats_t stats;
+#endif
 
 };
 
@@ -53,9 +230,34 @@ struct game {
 
 /**
  * Create and initialise a new game.
+ * @param baronies is the number of baronies, from 2 to MAX_BARONIES.
+ * @return the new game.
+ */
+game_t *new_game (int baronies);
+
+/**
+ * Create a copy of a game.
+ * The copy has reports of its own, and starts with none.
+ * @param game is the game to copy.
  * @return the new game.
  */
-game_t *new_game (void);
+game_t *game_clone (game_t *game);
+
+/**
+ * Copy one game over another without allocating any memory.
+ * The reports of the destination game are discarded. A destination
+ * with a different number of baronies is a fatal error.
+ * @param dest is a game with the same number of baronies.
+ * @param game is the game to copy.
+ */
+void game_copy_into (game_t *dest, game_t *game);
+
+/**
+ * Seed a game's random number generator.
+ * @param game is the game to seed.
+ * @param seed is the seed value.
+ */
+void seed_game (game_t *game, unsigned long int seed);
 
 /**
  * Process a single turn.
@@ -63,12 +265,102 @@ game_t *new_game (void);
  */
 void process_turn (game_t *game);
 
+/**
+ * Work out what each of a batch of candidates would do for a barony.
+ * Each candidate stands in for the order and attacks the barony has
+ * placed, and the payments, battles, deliveries and economy of the
+ * turn are worked out for it as process_turn would, without changing
+ * the game. What all candidates share is worked out once, and each
+ * candidate visits only the baronies it attacks. The game's working
+ * space is used, so this must not be called for a game that is
+ * being processed or evaluated elsewhere at the same time.
+ * @param game is the game in progress.
+ * @param b is the barony.
+ * @param candidates are the candidates to try.
+ * @param count is the number of candidates.
+ * @param summaries receive the barony's state after the turn, one
+ * for each candidate; its ranking is not worked out.
+ */
+void evaluate_candidates (game_t *game, int b, candidate_t *candidates,
+			  int count, summary_t *summaries);
+
 /**
  * Clean up after a game.
  * @param game is the game to clean up.
  */
 void end_game (game_t *game);
 
+/**
+ * Start or stop keeping the state hash of a game.
+ * A game kept hashed revises its hash with every change to the
+ * state, so that game_hash need not work it out from scratch.
+ * @param game is the game.
+ * @param hashing is 1 to keep the hash, 0 to stop.
+ */
+void keep_hash (game_t *game, int hashing);
+
+/**
+ * Set or clear the observer told of the results of a game's turns.
+ * The observer is not copied with the game or saved.
+ * @param game is the game.
+ * @param observer is the observer, or NULL for none.
+ */
+void set_observer (game_t *game, observer_t *observer);
+
+/**
+ * Set or clear the worker pool that shares out the work of a game's
+ * turns. Battles and the economy are worked out for many baronies at
+ * once, and the results merged in barony order, so that a turn
+ * comes out the same whatever the number of workers. The pool is not
+ * copied with the game, and may be shared by games that are not
+ * processed at the same time.
+ * @param game is the game.
+ * @param workers is the pool, or NULL to work in line.
+ */
+void set_workers (game_t *game, workers_t *workers);
+
+/**
+ * Set the rules a game is played to.
+ * The rules are copied, saved and journalled with the game.
+ * @param game is the game.
+ * @param rules are the rules.
+ * @return 1 if the rules were set, 0 if they are not valid.
+ */
+int set_rules (game_t *game, ruleset_t *rules);
+
+/**
+ * Get the rules a game is played to.
+ * @param game is the game.
+ * @return the rules, which must not be changed.
+ */
+ruleset_t *get_rules (game_t *game);
+
+/**
+ * Get the state hash of a game.
+ * The hash covers the turn number, the fields of the baronies that
+ * change in play, and the orders and attacks placed. Equal states
+ * have equal hashes. When compiled with DEBUG defined, a kept hash
+ * is checked against one worked out from scratch.
+ * @param game is the game.
+ * @return the hash.
+ */
+hash_t game_hash (game_t *game);
+
+/**
+ * Get the statistics of the stages of a game's turns.
+ * @param game is the game.
+ * @return the statistics, or NULL if they are not compiled in.
+ */
+game_stats_t *get_game_stats (game_t *game);
+
+/**
+ * Get the baronies in ranking order.
+ * Baronies with equal land are given in order of their numbers.
+ * @param game is the game in progress.
+ * @return an array of one rank per barony, best first.
+ */
+rank_t *get_rankings (game_t *game);
+
 /**
  * Work out the maximum number of castles affordable.
  * @param game is the game in progress.
@@ -108,8 +400,9 @@ int max_footmen_to_send (game_t *game, int o, int t);
 
 /**
  * Work out the expenses for a barony's military.
+ * @param game is the game in progress.
  * @param barony is the barony concerned.
  */
-unsigned long int calculate_expenses (barony_t *barony);
+unsigned long int calculate_expenses (game_t *game, barony_t *barony);
 
 #endif
@@ -0,0 +1,89 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * State Hash Header.
+ */
+
+#ifndef __HASH_H__
+#define __HASH_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* barony field numbers */
+#include "barony.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef unsigned long long int hash_t;
+typedef struct game game_t;
+typedef struct order order_t;
+typedef struct attack attack_t;
+
+/*
+ * The state hash is in the style of Zobrist: every element of the
+ * state has its own pseudo-random key, and the hash is the exclusive
+ * or of the keys of the elements present. An element is changed by
+ * taking its old key out and putting its new key in, both with an
+ * exclusive or. The keys are worked out when needed rather than
+ * looked up, as the values of the fields range too widely for tables.
+ */
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Get the key for a field of a barony having a value.
+ * @param b is the barony.
+ * @param field is the field.
+ * @param value is the value of the field.
+ * @return the key.
+ */
+hash_t barony_key (int b, barony_field_t field, int value);
+
+/**
+ * Get the key for a barony's order.
+ * @param b is the barony.
+ * @param order is the order placed.
+ * @return the key.
+ */
+hash_t order_key (int b, order_t *order);
+
+/**
+ * Get the key for an attack.
+ * @param attack is the attack.
+ * @return the key.
+ */
+hash_t attack_key (attack_t *attack);
+
+/**
+ * Get the key for the turn number.
+ * @param turn is the turn number.
+ * @return the key.
+ */
+hash_t turn_key (int turn);
+
+/**
+ * Work out the state hash of a game from scratch.
+ * @param game is the game.
+ * @return the hash.
+ */
+hash_t calculate_hash (game_t *game);
+
+/**
+ * Fold the holdings of a game's baronies into a running checksum.
+ * @param checksum is the checksum so far, or 0 for a game on its own.
+ * @param game is the game.
+ * @return the updated checksum.
+ */
+unsigned long int checksum_game (unsigned long int checksum,
+				 game_t *game);
+
+#endif
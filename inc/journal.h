@@ -0,0 +1,260 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Journal Header.
+ */
+
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+
+/* snapshots and their sizes */
+#include "save.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct keyframe keyframe_t;
+typedef struct journal_index journal_index_t;
+typedef struct journal journal_t;
+
+/*
+ * A journal is an append-only file of games. Each game starts with a
+ * snapshot of its state, as written by game_save, and is followed by
+ * a turn record for each turn processed. A turn record holds what was
+ * given to the turn and the state hash that came of it, as 32-bit
+ * little-endian numbers at fixed places:
+ *
+ *   header    JOURNAL_HEADER bytes, at the places given below
+ *   orders    JOURNAL_ORDER bytes for each order placed: barony,
+ *             castles, knights and footmen
+ *   attacks   SNAPSHOT_ATTACK bytes for each attack, in order of
+ *             origin and target: origin, target, knights and footmen
+ *
+ * A game is rebuilt by loading its snapshot and processing each of
+ * its turns again with the orders and attacks recorded; the hash in
+ * each record shows that the turn came out the same.
+ *
+ * Every so many turns a keyframe record is put between the turn
+ * records: KEYFRAME_HEADER bytes followed by a snapshot of the game
+ * as it stands. When a journal is closed, an index record is added
+ * giving the place of every game's first snapshot and keyframe:
+ *
+ *   header    INDEX_HEADER bytes, at the places given below
+ *   entries   INDEX_ENTRY bytes for each snapshot: game number, turn,
+ *             and place in the file, low word first
+ *   trailer   INDEX_TRAILER bytes: the size of the index record and
+ *             INDEX_TAIL, so that the index can be found from the end
+ *
+ * A game is rebuilt at any turn by loading the snapshot before it and
+ * replaying no more than the turns between keyframes. Every record
+ * starts with its magic and its size at the same places, so a reader
+ * can skip records it does not need; an index left in the middle of
+ * a file by an earlier writer is skipped in this way.
+ */
+
+/** @def JOURNAL_MAGIC identifies a turn record and its version. */
+#define JOURNAL_MAGIC "ANK100T"
+
+/** @def KEYFRAME_MAGIC identifies a keyframe record. */
+#define KEYFRAME_MAGIC "ANK100K"
+
+/** @def INDEX_MAGIC identifies an index record. */
+#define INDEX_MAGIC "ANK100X"
+
+/** @def INDEX_TAIL ends an index record. */
+#define INDEX_TAIL "IDX"
+
+/** @def JOURNAL_INTERVAL is the usual number of turns per keyframe. */
+#define JOURNAL_INTERVAL 4
+
+/* places of the values in a turn record's header */
+#define JOURNAL_SIZE 8 /* size of the whole record in bytes */
+#define JOURNAL_TURN 12 /* turn number before the turn */
+#define JOURNAL_SEED 16 /* random number seed */
+#define JOURNAL_RNG 20 /* four words of generator state */
+#define JOURNAL_HASH 36 /* state hash after the turn, low word first */
+#define JOURNAL_ORDERS 44 /* number of orders */
+#define JOURNAL_ATTACKS 48 /* number of attacks */
+
+/* places of the values in an index record's header */
+#define INDEX_GAMES 12 /* number of games in the file */
+#define INDEX_ENTRIES 16 /* number of entries */
+
+/* sizes of the parts of the records */
+#define JOURNAL_HEADER 52
+#define JOURNAL_ORDER 16
+#define KEYFRAME_HEADER 16
+#define INDEX_HEADER 20
+#define INDEX_ENTRY 16
+#define INDEX_TRAILER 8
+
+/** @def JOURNAL_ATTACK_PLACE is the place of an attack in a record. */
+#define JOURNAL_ATTACK_PLACE(orders, a) \
+    (JOURNAL_HEADER + (unsigned long int) (orders) * JOURNAL_ORDER \
+     + (unsigned long int) (a) * SNAPSHOT_ATTACK)
+
+/** @def INDEX_SIZE is the size of an index record. */
+#define INDEX_SIZE(entries) \
+    (INDEX_HEADER + (unsigned long int) (entries) * INDEX_ENTRY \
+     + INDEX_TRAILER)
+
+/**
+ * @struct keyframe is an entry in a journal's index.
+ */
+struct keyframe {
+
+    /** @var game is the number of the game in the file, from 0. */
+    long int game;
+
+    /** @var turn is the turn the game had reached. */
+    int turn;
+
+    /** @var place is the place of the snapshot in the file. */
+    long int place;
+
+};
+
+/**
+ * @struct journal_index is the index of a journal file.
+ */
+struct journal_index {
+
+    /** @var games is the number of games in the file. */
+    long int games;
+
+    /** @var count is the number of keyframes. */
+    long int count;
+
+    /** @var capacity is the number of keyframes there is room for. */
+    long int capacity;
+
+    /** @var keyframes are the keyframes in order of game and turn. */
+    keyframe_t *keyframes;
+
+};
+
+/**
+ * @struct journal is a journal file being written.
+ */
+struct journal {
+
+    /** @var output is the journal file. */
+    FILE *output;
+
+    /** @var interval is the number of turns between keyframes. */
+    int interval;
+
+    /** @var index is the index of the file so far. */
+    journal_index_t *index;
+
+    /** @var record is working space for a turn record. */
+    unsigned char *record;
+
+    /** @var capacity is the size of the working space. */
+    unsigned long int capacity;
+
+};
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Open a journal file for writing.
+ * Games already in the file are kept, and new games are added after
+ * them; the file must be empty or a valid journal.
+ * @param output is the journal file, open for reading and appending.
+ * @param interval is the number of turns between keyframes, or 0 for
+ * none after each game's first snapshot.
+ * @return the new journal, or NULL if the file is not a journal.
+ */
+journal_t *new_journal (FILE *output, int interval);
+
+/**
+ * Start recording a game in a journal.
+ * The game's snapshot is appended to the file straight away.
+ * @param journal is the journal.
+ * @param game is the game to record.
+ * @return 1 if the game was started, 0 if the file could not be
+ * written.
+ */
+int journal_game (journal_t *journal, game_t *game);
+
+/**
+ * Process a single turn, appending it to a journal.
+ * @param game is the game to process, the last started in the journal.
+ * @param journal is the journal the game is recorded in.
+ * @return 1 if the turn was recorded, 0 if the file could not be
+ * written.
+ */
+int process_turn_journal (game_t *game, journal_t *journal);
+
+/**
+ * Close a journal, writing its index. The file is left open.
+ * @param journal is the journal to close.
+ * @return 1 if the index was written, 0 if not.
+ */
+int end_journal (journal_t *journal);
+
+/**
+ * Move to the next game in a journal file, skipping any index.
+ * @param input is the journal file, between games.
+ * @return 1 if a game follows, 0 at the end of the file, or -1 if
+ * the file is not valid.
+ */
+int next_game (FILE *input);
+
+/**
+ * Rebuild the next game in a journal file without a display.
+ * Reports are not made while the turns are replayed. If fewer than
+ * all of the game's turns are replayed, the rest are skipped so that
+ * the file is left at the start of the next game.
+ * @param input is the journal file, at the start of a game.
+ * @param turns is the number of turns to replay, or -1 for all.
+ * @param replayed if not NULL receives the number of turns replayed.
+ * @return the game, or NULL if the journal is not valid or a turn
+ * did not come out as recorded.
+ */
+game_t *replay_journal (FILE *input, int turns, long int *replayed);
+
+/**
+ * Read the index of a journal file.
+ * If the file has no index at its end, for instance because the
+ * writer did not close it, the index is rebuilt by reading the file.
+ * @param input is the journal file.
+ * @return the index, or NULL if the file is not valid.
+ */
+journal_index_t *read_journal_index (FILE *input);
+
+/**
+ * Rebuild a game in a journal file as it stood at a given turn.
+ * The game is loaded from the last snapshot before the turn, and the
+ * turns after the snapshot are replayed as by replay_journal.
+ * @param input is the journal file.
+ * @param index is the index of the file.
+ * @param game is the number of the game in the file, from 0.
+ * @param turn is the turn.
+ * @return the game, or NULL if the journal does not reach the turn,
+ * is not valid, or a turn did not come out as recorded.
+ */
+game_t *seek_journal (FILE *input, journal_index_t *index,
+		      long int game, int turn);
+
+/**
+ * Destroy a journal index when it is no longer needed.
+ * @param index is the index to destroy.
+ */
+void end_journal_index (journal_index_t *index);
+
+#endif
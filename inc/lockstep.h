@@ -0,0 +1,38 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Lockstep Engine Header.
+ */
+
+#ifndef __LOCKSTEP_H__
+#define __LOCKSTEP_H__
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct game game_t;
+
+/*
+ * The lockstep engine advances a block of games by a turn at once,
+ * so that a caller playing many games can keep them all in step.
+ * Each game is processed by process_turn, and so gives the same
+ * results as it would on its own. Games whose turns are over are
+ * left alone.
+ */
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Process a single turn of many games.
+ * @param games are the games, each with its orders and attacks.
+ * @param count is the number of games.
+ */
+void process_lockstep (game_t **games, int count);
+
+#endif
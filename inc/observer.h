@@ -0,0 +1,73 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Observer Header.
+ */
+
+#ifndef __OBSERVER_H__
+#define __OBSERVER_H__
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct observer observer_t;
+typedef struct game game_t;
+typedef struct order order_t;
+typedef struct battle battle_t;
+typedef struct attack_report attack_report_t;
+
+/*
+ * An observer is told of the results of a turn as process_turn works
+ * them out, whether or not reports are being made. Baronies are given
+ * by number. Any callback may be NULL, and a game with no observer
+ * pays a single test for each place an event could arise. Callbacks
+ * must not change the game. Battles and the economy are worked out
+ * for every barony before their callbacks are made, in barony order,
+ * so the game may already show the results for later baronies.
+ */
+
+/**
+ * @struct observer is a set of callbacks for the events of a turn.
+ */
+struct observer {
+
+    /** @var data is for the observer's own use. */
+    void *data;
+
+    /**
+     * @var battle is called for each attacker's share of a battle,
+     * in origin order at each target, before the shares are applied;
+     * outcome is the battle as a whole.
+     */
+    void (*battle) (observer_t *observer, game_t *game, int origin,
+		    int target, attack_report_t *share,
+		    battle_t *outcome);
+
+    /**
+     * @var delivery is called for each order placed, with delivered
+     * 1 if it was paid for and its units added, 0 if not.
+     */
+    void (*delivery) (observer_t *observer, game_t *game, int b,
+		      order_t *order, int delivered);
+
+    /**
+     * @var migration is called for each barony's change in
+     * population and the tax raised from it.
+     */
+    void (*migration) (observer_t *observer, game_t *game, int b,
+		       int migration, int tax);
+
+    /**
+     * @var desertion is called for each barony that cannot meet its
+     * expenses, with the units it has lost.
+     */
+    void (*desertion) (observer_t *observer, game_t *game, int b,
+		       int castles, int knights, int footmen);
+
+};
+
+#endif
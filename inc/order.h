@@ -15,13 +15,16 @@
 
 /* typdefs */
 typedef struct order order_t;
-typedef struct barony barony_t;
+typedef struct game game_t;
 
-/** @struct order is the data for a building and recruitment order. */
+/**
+ * @struct order is the data for a building and recruitment order.
+ * Orders are held by value in the game, one for each barony.
+ */
 struct order {
 
-    /** @var barony is the barony making the instruction. */
-    barony_t *barony;
+    /** @var placed is 1 if the order has been placed, 0 if not. */
+    int placed;
 
     /** @var castles is the number of castles to build. */
     int castles;
@@ -42,24 +45,42 @@ struct order {
  */
 
 /**
- * Create a new building and recruitment order.
- * @param barony is the barony placing the order.
+ * Place a new, empty building and recruitment order.
+ * Any order the barony has already placed is replaced.
+ * @param game is the game in progress.
+ * @param b is the barony placing the order.
  * @return the new order.
  */
-order_t *new_order (barony_t *barony);
+order_t *new_order (game_t *game, int b);
+
+/**
+ * Place a building and recruitment order.
+ * Any order the barony has already placed is replaced. Orders are
+ * part of the state hash, so they are changed only through this
+ * function and the others here, not by writing to them.
+ * @param game is the game in progress.
+ * @param b is the barony placing the order.
+ * @param castles is the number of castles to build.
+ * @param knights is the number of knights to train.
+ * @param footmen is the number of footmen to draft.
+ * @return the order.
+ */
+order_t *set_order (game_t *game, int b, int castles, int knights,
+		    int footmen);
 
 /**
- * Calculate the cost of an order in population.
- * @param order is the order to process.
- * @return the cost in population.
+ * Get a barony's order if it has placed one.
+ * @param game is the game in progress.
+ * @param b is the barony.
+ * @return a pointer to the order, or NULL if there is none.
  */
-int order_popcost (order_t *order);
+order_t *get_order (game_t *game, int b);
 
 /**
- * Calculate the cost of an order in gold.
- * @param order is the order to process.
- * @return the cost in gold.
+ * Cancel a barony's order.
+ * @param game is the game in progress.
+ * @param b is the barony.
  */
-int order_goldcost (order_t *order);
+void cancel_order (game_t *game, int b);
 
 #endif
@@ -0,0 +1,57 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Random Number Generator Header.
+ */
+
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct random random_t;
+
+/**
+ * @struct random is the state of a random number generator.
+ * The generator is xoshiro128**, kept to 32-bit arithmetic so that it
+ * gives the same sequence on 16-bit and 64-bit compilers.
+ */
+struct random {
+
+    /** @var state is the 128-bit generator state. */
+    unsigned long int state[4];
+
+};
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Seed a random number generator.
+ * @param rng is the generator to seed.
+ * @param seed is the seed value.
+ */
+void seed_random (random_t *rng, unsigned long int seed);
+
+/**
+ * Get the next raw 32-bit number from a generator.
+ * @param rng is the generator to use.
+ * @return a number from 0 to 0xffffffff.
+ */
+unsigned long int next_random (random_t *rng);
+
+/**
+ * Get a random number within a range.
+ * @param rng is the generator to use.
+ * @param range is the number of possible values.
+ * @return a number from 0 to range - 1.
+ */
+int random_number (random_t *rng, int range);
+
+#endif
@@ -13,6 +13,9 @@
  * Included Headers.
  */
 
+/* standard C headers */
+#include <stddef.h>
+
 /* main header required for some constant definitions */
 #include "anarchic.h"
 
@@ -20,11 +23,19 @@
  * Data Definitions.
  */
 
+/** @enum report_policy_t enumerates which baronies get reports. */
+typedef enum {
+    REPORT_ALL, /* every barony gets a report */
+    REPORT_PLAYERS, /* only human and remote baronies get reports */
+    REPORT_NONE /* no reports are produced */
+} report_policy_t;
+
 /* defined types for structures */
 typedef struct report report_t;
 typedef struct barony barony_t;
 typedef struct attack_report attack_report_t;
 typedef struct unit_report unit_report_t;
+typedef struct arena arena_t;
 
 /** @struct report is the data for a report. */
 struct report {
@@ -32,11 +43,20 @@ struct report {
     /** @var barony is the barony the report is addressed to. */
     barony_t *barony;
 
-    /** @var outbound are outbound attack reports. */
-    attack_report_t *attacks[BARONIES];
+    /** @var attacks are outbound attack reports, in target order. */
+    attack_report_t *attacks;
+
+    /**
+     * @var defences are inbound attack reports, in origin order.
+     * Each is the same record as the attacker's outbound report.
+     */
+    attack_report_t *defences;
+
+    /** @var last_attack is the last outbound report, for appending. */
+    attack_report_t *last_attack;
 
-    /** @var inbound are inbound attack reports. */
-    attack_report_t *defences[BARONIES];
+    /** @var last_defence is the last inbound report, for appending. */
+    attack_report_t *last_defence;
 
     /** @var migration is the population change. */
     int migration;
@@ -55,7 +75,10 @@ struct report {
 
 };
 
-/** @struct attack_report is a report on an attack. */
+/**
+ * @struct attack_report is a report on an attack.
+ * One record serves as both the attacker's and the defender's report.
+ */
 struct attack_report {
 
     /** @var origin is the barony whence the attack came. */
@@ -91,6 +114,12 @@ struct attack_report {
     /** @var footmenslain is the number of defending footmen slain. */
     int footmen_slain;
 
+    /** @var next_attack is the origin's next outbound report. */
+    attack_report_t *next_attack;
+
+    /** @var next_defence is the target's next inbound report. */
+    attack_report_t *next_defence;
+
 };
 
 /** @struct unit_report is a report on units ordered. */
@@ -111,25 +140,29 @@ struct unit_report {
  * Function Prototypes.
  */
 
+/**
+ * Work out the arena size needed for the most reports in a turn.
+ * @param baronies is the number of baronies in the game.
+ * @return the size in bytes.
+ */
+size_t report_arena_size (int baronies);
+
 /**
  * Create and initialise a new report.
+ * @param arena is the arena to allocate the report from.
  * @param barony is the barony the report is addressed to.
  * @return the new report.
  */
-report_t *new_report (barony_t *barony);
+report_t *new_report (arena_t *arena, barony_t *barony);
 
 /**
  * Create a unit report and stuff it with values.
+ * @param arena is the arena to allocate the report from.
  * @param castles is the number of castles built.
  * @param knights is the number of knights trained.
  * @param footmen is the number of footmen drafted.
  */
-unit_report_t *new_unit_report (int castles, int knights, int footmen);
-
-/**
- * Destroy a report when no longer needed.
- * @param report is the report to destroy.
- */
-void destroy_report (report_t *report);
+unit_report_t *new_unit_report (arena_t *arena, int castles,
+				int knights, int footmen);
 
 #endif
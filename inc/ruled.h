@@ -0,0 +1,182 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Ruled Function Template.
+ *
+ * The parts of a turn that depend on the rules, written once for any
+ * ruleset. The game module includes this file once for the stock
+ * rules and once for a game's own, having defined the names below;
+ * the file undefines them at its end, ready for the next.
+ *
+ *   RULES(name)   the name of a function for this ruleset
+ *   RULE(field)   the value of a field of the ruleset, for the game
+ *                 in hand
+ *
+ * For the stock rules, RULE reads a constant ruleset, so that the
+ * compiler can fold every rule into the code; the game module calls
+ * these versions unless a game has rules of its own.
+ */
+
+/*----------------------------------------------------------------------
+ * Level 3 Private Functions.
+ */
+
+/**
+ * Apply an attacker's gains and losses from a battle.
+ * @param game is the game in play.
+ * @param origin is the barony originating the attack.
+ * @param report is the attacker's share of the battle.
+ */
+static void RULES (take_gains) (game_t *game, barony_t *origin,
+				attack_report_t *report)
+{
+    /* transfer land, gold and castle gains, and return the forces */
+    origin->land += report->land_taken;
+    origin->gold += report->gold_looted;
+    origin->castles += report->castles_taken;
+    origin->knights += report->knights_sent - report->knights_lost;
+    origin->footmen += report->footmen_sent - report->footmen_lost;
+
+    /* ensure that gains do not push values outside permitted range */
+    if (origin->gold > RULE (max_gold))
+	origin->gold = RULE (max_gold);
+    if (origin->castles > RULE (max_castles))
+	origin->castles = RULE (max_castles);
+}
+
+/**
+ * Pay for a barony's order if it can be afforded.
+ * @param game is the game in play.
+ * @param barony is the barony placing the order.
+ * @param order is the order placed.
+ * @return 1 if the order was paid for, 0 if not.
+ */
+static int RULES (pay_order) (game_t *game, barony_t *barony,
+			      order_t *order)
+{
+    unsigned long int cost; /* cost of order in population and gold */
+    cost = (unsigned long int) order->castles * RULE (castle_cost)
+	+ (unsigned long int) order->knights * RULE (knight_cost)
+	+ order->footmen;
+    if (cost > (unsigned long int) barony->population
+	|| cost > (unsigned long int) barony->gold)
+	return 0;
+    barony->population -= cost;
+    barony->gold -= cost;
+    return 1;
+}
+
+/**
+ * Deliver the units of a paid order to a barony.
+ * @param game is the game in play.
+ * @param barony is the barony that placed the order.
+ * @param order is the order.
+ */
+static void RULES (deliver_order) (game_t *game, barony_t *barony,
+				   order_t *order)
+{
+    /* deliver the units */
+    barony->castles += order->castles;
+    barony->knights += order->knights;
+    barony->footmen += order->footmen;
+
+    /* ensure units do not break limits */
+    if (barony->castles > RULE (max_castles))
+	barony->castles = RULE (max_castles);
+    if (barony->knights > RULE (max_knights))
+	barony->knights = RULE (max_knights);
+    if (barony->footmen > RULE (max_footmen))
+	barony->footmen = RULE (max_footmen);
+}
+
+/**
+ * Work out the expenses for a barony's military.
+ * @param game is the game in play.
+ * @param barony is the barony concerned.
+ * @return the expenses.
+ */
+static unsigned long int RULES (barony_expenses) (game_t *game,
+						  barony_t *barony)
+{
+    return (unsigned long int)
+	(barony->castles * RULE (castles_tax) / RULE (castles_per_tax)
+	 + barony->knights * RULE (knights_tax) / RULE (knights_per_tax)
+	 + barony->footmen * RULE (footmen_tax)
+	 / RULE (footmen_per_tax));
+}
+
+/**
+ * Process the economic activity of one barony.
+ * Nothing is written but the barony and its economy, so many
+ * baronies can be done at once.
+ * @param game is the game in play.
+ * @param barony is the barony.
+ * @param economy receives the results, for the reports and observer.
+ */
+static void RULES (barony_economy) (game_t *game, barony_t *barony,
+				    economy_t *economy)
+{
+    /* local variables */
+    unsigned long int expenses; /* cost of upkeep of units */
+    float desertion; /* fraction of military that deserts */
+    barony_t before; /* the barony before any desertion */
+
+    /* work out and apply population changes and taxes */
+    economy->migration = (barony->land - barony->population) / 2;
+    economy->tax = barony->population / RULE (population_per_gold);
+    barony->population += economy->migration;
+    barony->gold += economy->tax;
+
+    /* work out expenses */
+    expenses = RULES (barony_expenses) (game, barony);
+
+    /* reduce military if not affordable */
+    economy->deserted = expenses > barony->gold;
+    if (economy->deserted) {
+	before = *barony;
+
+	/*
+	 * in integers, gold / expenses is always 0 here, so exactly
+	 * half deserts and half remains, each rounded down as in the
+	 * floating point version
+	 */
+	if (game->battle_math == MATH_INTEGER) {
+	    barony->castles /= 2;
+	    barony->knights /= 2;
+	    barony->footmen /= 2;
+	    economy->attrition.castles = barony->castles;
+	    economy->attrition.knights = barony->knights;
+	    economy->attrition.footmen = barony->footmen;
+	}
+
+	/* ...or in floating point */
+	else {
+	    desertion = (1.0 - barony->gold / expenses) / 2;
+	    economy->attrition.castles = desertion * barony->castles;
+	    economy->attrition.knights = desertion * barony->knights;
+	    economy->attrition.footmen = desertion * barony->footmen;
+	    barony->castles *= (1 - desertion);
+	    barony->knights *= (1 - desertion);
+	    barony->footmen *= (1 - desertion);
+	}
+	expenses = barony->gold;
+
+	/* note the units lost */
+	economy->lost.castles = before.castles - barony->castles;
+	economy->lost.knights = before.knights - barony->knights;
+	economy->lost.footmen = before.footmen - barony->footmen;
+    }
+
+    /* apply the expenses */
+    barony->gold -= expenses;
+
+    /* check that gold remains within limits */
+    if (barony->gold > RULE (max_gold))
+	barony->gold = RULE (max_gold);
+}
+
+/* ready for the next ruleset */
+#undef RULES
+#undef RULE
@@ -0,0 +1,177 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Ruleset Header.
+ */
+
+#ifndef __RULES_H__
+#define __RULES_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+
+/* main project header, for the stock rules */
+#include "anarchic.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct ruleset ruleset_t;
+
+/*
+ * A ruleset holds the numbers that balance the game, so that a game
+ * can be played to rules other than the stock ones without
+ * recompiling. A game starts with the stock rules, and set_rules
+ * gives it others. The fields are ints, and a ruleset file gives any
+ * of them by name, one to a line:
+ *
+ *   # a comment
+ *   castle_cost 80
+ *   knight_value 12
+ *
+ * Fields not named keep their values. The divisors and the costs of
+ * castles and knights must be at least 1, and the rest may not be
+ * negative.
+ */
+
+/** @struct ruleset holds the rules of a game. */
+struct ruleset {
+
+    /** @var population_per_gold is 1/ the tax per population. */
+    int population_per_gold;
+
+    /** @var castle_cost is the price of a castle. */
+    int castle_cost;
+
+    /** @var knight_cost is the price of a knight. */
+    int knight_cost;
+
+    /** @var castles_tax is the upkeep of castles_per_tax castles. */
+    int castles_tax;
+
+    /** @var castles_per_tax is the castles paying castles_tax. */
+    int castles_per_tax;
+
+    /** @var knights_tax is the upkeep of knights_per_tax knights. */
+    int knights_tax;
+
+    /** @var knights_per_tax is the knights paying knights_tax. */
+    int knights_per_tax;
+
+    /** @var footmen_tax is the upkeep of footmen_per_tax footmen. */
+    int footmen_tax;
+
+    /** @var footmen_per_tax is the footmen paying footmen_tax. */
+    int footmen_per_tax;
+
+    /** @var knight_value is the worth of a knight in footmen. */
+    int knight_value;
+
+    /** @var castle_value is the worth of a castle in footmen. */
+    int castle_value;
+
+    /** @var max_gold is the most gold a barony can hold. */
+    int max_gold;
+
+    /** @var max_castles is the most castles a barony can hold. */
+    int max_castles;
+
+    /** @var max_knights is the most knights a barony can hold. */
+    int max_knights;
+
+    /** @var max_footmen is the most footmen a barony can hold. */
+    int max_footmen;
+
+};
+
+/** @const RULE_FIELDS is the number of fields in a ruleset. */
+#define RULE_FIELDS 15
+
+/** @def STOCK_RULES initialises a ruleset to the stock rules. */
+#define STOCK_RULES { \
+    POPULATION_PER_GOLD, CASTLE_COST, KNIGHT_COST, \
+    CASTLES_TAX, CASTLES_PER_TAX, KNIGHTS_TAX, KNIGHTS_PER_TAX, \
+    FOOTMEN_TAX, FOOTMEN_PER_TAX, KNIGHT_VALUE, CASTLE_VALUE, \
+    MAX_GOLD, MAX_CASTLES, MAX_KNIGHTS, MAX_FOOTMEN \
+}
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Get one of the fields of a ruleset.
+ * Fields are numbered in the order of the ruleset structure.
+ * @param rules is the ruleset.
+ * @param f is the field number.
+ * @return a pointer to the field.
+ */
+int *rule_field (ruleset_t *rules, int f);
+
+/**
+ * Get the name of a field of a ruleset.
+ * @param f is the field number.
+ * @return the name of the field.
+ */
+char *rule_name (int f);
+
+/**
+ * Get the least value allowed in a field of a ruleset.
+ * @param f is the field number.
+ * @return the least value.
+ */
+int rule_minimum (int f);
+
+/**
+ * Find a field of a ruleset by name.
+ * @param name is the name of the field.
+ * @return the field number, or -1 if there is no such field.
+ */
+int find_rule (char *name);
+
+/**
+ * Set a ruleset to the stock rules.
+ * @param rules is the ruleset.
+ */
+void stock_rules (ruleset_t *rules);
+
+/**
+ * Check whether a ruleset is the stock rules.
+ * @param rules is the ruleset.
+ * @return 1 if it is, 0 if any field differs.
+ */
+int is_stock_rules (ruleset_t *rules);
+
+/**
+ * Check that a ruleset can be played.
+ * @param rules is the ruleset.
+ * @return 1 if it can, 0 if a field is out of range.
+ */
+int valid_rules (ruleset_t *rules);
+
+/**
+ * Read the fields of a ruleset from a file.
+ * The ruleset is left unchanged unless the whole file is valid.
+ * @param rules is the ruleset to change.
+ * @param input is the file to read.
+ * @return 1 if successful, 0 if the file is not a valid ruleset.
+ */
+int read_rules (ruleset_t *rules, FILE *input);
+
+/**
+ * Write a ruleset to a file in the form read_rules reads.
+ * @param rules is the ruleset.
+ * @param output is the file to write to.
+ * @return 1 if successful, 0 on error.
+ */
+int write_rules (ruleset_t *rules, FILE *output);
+
+#endif
@@ -0,0 +1,150 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Saved Game Header.
+ */
+
+#ifndef __SAVE_H__
+#define __SAVE_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+
+/* barony field numbers */
+#include "barony.h"
+
+/* number of rule fields */
+#include "rules.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct game game_t;
+
+/*
+ * A snapshot is a game saved as a block of 32-bit little-endian
+ * numbers at fixed places, so that it reads the same on any machine
+ * and can be read in place from a mapped file. Every part is a whole
+ * number of 32-bit words, so snapshots can follow one another in a
+ * file and each stays aligned. A snapshot is laid out as follows:
+ *
+ *   header    SNAPSHOT_HEADER bytes, at the places given below,
+ *             ending with the fields of the rules in the order of
+ *             the ruleset structure
+ *   baronies  SNAPSHOT_BARONY bytes for each barony: its name,
+ *             padded with nulls, its control, and its changing
+ *             fields in the order of barony_field_t
+ *   orders    SNAPSHOT_ORDER bytes for each barony: placed, castles,
+ *             knights, footmen and paid
+ *   rankings  4 bytes for each place: the barony in that place
+ *   attacks   SNAPSHOT_ATTACK bytes for each attack, in order of
+ *             origin and target: origin, target, knights and footmen
+ */
+
+/** @def SNAPSHOT_MAGIC identifies a snapshot and its version. */
+#define SNAPSHOT_MAGIC "ANK102S"
+
+/* places of the values in the header */
+#define SNAPSHOT_SIZE 8 /* size of the whole snapshot in bytes */
+#define SNAPSHOT_BARONIES 12 /* number of baronies */
+#define SNAPSHOT_TURN 16 /* turn number */
+#define SNAPSHOT_SEED 20 /* random number seed */
+#define SNAPSHOT_RNG 24 /* four words of generator state */
+#define SNAPSHOT_REPORTS 40 /* report policy */
+#define SNAPSHOT_MATH 44 /* battle arithmetic */
+#define SNAPSHOT_ATTACKS 48 /* number of attacks */
+#define SNAPSHOT_RULES 52 /* the fields of the rules */
+
+/* sizes of the parts of a snapshot */
+#define SNAPSHOT_HEADER (SNAPSHOT_RULES + 4 * RULE_FIELDS)
+#define SNAPSHOT_NAME 16
+#define SNAPSHOT_BARONY (SNAPSHOT_NAME + 4 + 4 * BARONY_FIELDS)
+#define SNAPSHOT_ORDER 20
+#define SNAPSHOT_ATTACK 16
+
+/** @def BARONY_PLACE is the place of a barony in a snapshot. */
+#define BARONY_PLACE(b) \
+    (SNAPSHOT_HEADER + (unsigned long int) (b) * SNAPSHOT_BARONY)
+
+/** @def ORDER_PLACE is the place of an order in a snapshot. */
+#define ORDER_PLACE(baronies, b) \
+    (BARONY_PLACE (baronies) \
+     + (unsigned long int) (b) * SNAPSHOT_ORDER)
+
+/** @def RANK_PLACE is the place of a ranking place in a snapshot. */
+#define RANK_PLACE(baronies, p) \
+    (ORDER_PLACE (baronies, baronies) + (unsigned long int) (p) * 4)
+
+/** @def ATTACK_PLACE is the place of an attack in a snapshot. */
+#define ATTACK_PLACE(baronies, a) \
+    (RANK_PLACE (baronies, baronies) \
+     + (unsigned long int) (a) * SNAPSHOT_ATTACK)
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Work out the size of the snapshot of a game.
+ * @param game is the game.
+ * @return the size in bytes.
+ */
+unsigned long int snapshot_size (game_t *game);
+
+/**
+ * Write the snapshot of a game to memory.
+ * @param game is the game.
+ * @param snapshot is a block of snapshot_size bytes.
+ */
+void write_snapshot (game_t *game, unsigned char *snapshot);
+
+/**
+ * Get a value from a snapshot in place.
+ * @param snapshot is the snapshot.
+ * @param place is the place of the value.
+ * @return the value.
+ */
+long int snapshot_value (unsigned char *snapshot,
+			 unsigned long int place);
+
+/**
+ * Put a value into a snapshot.
+ * @param snapshot is the snapshot.
+ * @param place is the place of the value.
+ * @param value is the value, which must fit in 32 bits.
+ */
+void set_snapshot_value (unsigned char *snapshot,
+			 unsigned long int place, long int value);
+
+/**
+ * Create a game from a snapshot in memory.
+ * @param snapshot is the snapshot.
+ * @param size is the number of bytes available to read.
+ * @return the game, or NULL if the snapshot is not valid.
+ */
+game_t *read_snapshot (unsigned char *snapshot, unsigned long int size);
+
+/**
+ * Save a game to a file.
+ * @param game is the game to save.
+ * @param output is the file to write to.
+ * @return 1 if the game was saved, 0 if the file could not be written.
+ */
+int game_save (game_t *game, FILE *output);
+
+/**
+ * Load a game from a file.
+ * @param input is the file to read from.
+ * @return the game, or NULL if no valid snapshot could be read.
+ */
+game_t *game_load (FILE *input);
+
+#endif
@@ -0,0 +1,120 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Statistics Header.
+ */
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @enum stage_t enumerates the stages of a turn that are timed. */
+typedef enum {
+    STAGE_COMPUTER_TURNS,
+    STAGE_CLEAR_REPORTS,
+    STAGE_TAKE_PAYMENTS,
+    STAGE_FIGHT_BATTLES,
+    STAGE_DELIVER_UNITS,
+    STAGE_PROCESS_ECONOMY,
+    STAGE_CALCULATE_RANKINGS,
+    STAGES
+} stage_t;
+
+/* typedefs */
+typedef struct game_stats game_stats_t;
+typedef unsigned long long int stats_time_t;
+
+/*
+ * Each game counts the calls to the stages of its turns and the time
+ * spent in them when the library is compiled with GAME_STATS defined.
+ * Otherwise the game holds no statistics, get_game_stats returns
+ * NULL, and TIME_STAGE is the bare call, so that nothing is added to
+ * a turn.
+ */
+
+/** @struct game_stats holds the calls to and time in each stage. */
+struct game_stats {
+
+    /** @var calls is the number of calls to each stage. */
+    unsigned long int calls[STAGES];
+
+    /** @var nanoseconds is the time spent in each stage. */
+    stats_time_t nanoseconds[STAGES];
+
+};
+
+/**
+ * @def TIME_STAGE makes a call to a stage of a game's turn, timing it
+ * if statistics are compiled in.
+ */
+#ifdef GAME_STATS
+#define TIME_STAGE(game, stage, call) \
+    { \
+	stats_time_t start_; \
+	start_ = stats_clock (); \
+	call; \
+	stage_done (&(game)->stats, (stage), start_); \
+    }
+#else
+#define TIME_STAGE(game, stage, call) call
+#endif
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Read the high-resolution clock.
+ * @return the time in nanoseconds from some fixed point.
+ */
+stats_time_t stats_clock (void);
+
+/**
+ * Count a call to a stage and the time spent in it.
+ * @param stats are the statistics to add to.
+ * @param stage is the stage.
+ * @param start is the time the stage started.
+ */
+void stage_done (game_stats_t *stats, stage_t stage,
+		 stats_time_t start);
+
+/**
+ * Clear a set of statistics.
+ * @param stats are the statistics to clear.
+ */
+void clear_game_stats (game_stats_t *stats);
+
+/**
+ * Add one set of statistics to another.
+ * @param total are the statistics to add to.
+ * @param stats are the statistics to add.
+ */
+void add_game_stats (game_stats_t *total, game_stats_t *stats);
+
+/**
+ * Get the name of a stage.
+ * @param stage is the stage.
+ * @return the name of the function that carries it out.
+ */
+char *stage_name (stage_t stage);
+
+/**
+ * Write a table of statistics.
+ * @param output is the file to write to.
+ * @param stats are the statistics.
+ */
+void dump_game_stats (FILE *output, game_stats_t *stats);
+
+#endif
@@ -0,0 +1,68 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Worker Pool Header.
+ */
+
+#ifndef __WORKERS_H__
+#define __WORKERS_H__
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct workers workers_t;
+
+/**
+ * @typedef work_t is a function that does the work on a run of
+ * items, from first up to but not including last.
+ */
+typedef void (*work_t) (void *context, int first, int last);
+
+/*
+ * A worker pool shares out work on a range of items between threads.
+ * The items are divided into one run for each thread, the caller
+ * taking the first, so each thread's items are fixed by the count of
+ * items and threads alone. Where the library is built without
+ * threads, a pool has one worker, the caller, and work runs in line.
+ */
+
+/*----------------------------------------------------------------------
+ * Function Prototypes.
+ */
+
+/**
+ * Create a worker pool.
+ * @param count is the number of workers wanted, counting the caller.
+ * @return the new pool.
+ */
+workers_t *new_workers (int count);
+
+/**
+ * Get the number of workers in a pool.
+ * @param workers is the pool.
+ * @return the number of workers, counting the caller.
+ */
+int worker_count (workers_t *workers);
+
+/**
+ * Do some work on a range of items, and wait for it to finish.
+ * @param workers is the pool.
+ * @param work is the function to do the work.
+ * @param context is passed to the function.
+ * @param items is the number of items.
+ * @param least is the fewest items worth giving a worker.
+ */
+void run_workers (workers_t *workers, work_t work, void *context,
+		  int items, int least);
+
+/**
+ * Stop the workers of a pool and free it.
+ * @param workers is the pool.
+ */
+void end_workers (workers_t *workers);
+
+#endif
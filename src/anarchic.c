@@ -46,7 +46,7 @@ static void initialise (int argc, char **argv)
 {
     /* beta_check (); */
     state = display_open (argc, argv);
-    game = new_game ();
+    game = new_game (BARONIES);
 }
 
 /**
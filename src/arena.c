@@ -0,0 +1,87 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Arena Allocator Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "arena.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const ALIGNMENT is the boundary every object is aligned to. */
+#define ALIGNMENT (sizeof (long int) > sizeof (void *) \
+		   ? sizeof (long int) \
+		   : sizeof (void *))
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Initialise an arena with a block of memory.
+ * @param arena is the arena to initialise.
+ * @param size is the size of the block to reserve.
+ */
+void init_arena (arena_t *arena, size_t size)
+{
+    if (! (arena->memory = malloc (size)))
+	fatal_error (FATAL_MEMORY);
+    arena->size = size;
+    arena->used = 0;
+}
+
+/**
+ * Allocate an object from an arena.
+ * @param arena is the arena to allocate from.
+ * @param size is the size of the object.
+ * @return a pointer to the object.
+ */
+void *arena_alloc (arena_t *arena, size_t size)
+{
+    void *object; /* the object to return */
+
+    /* round the size up to keep the next object aligned */
+    size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (arena->used + size > arena->size)
+	fatal_error (FATAL_MEMORY);
+
+    /* carve the object from the block */
+    object = arena->memory + arena->used;
+    arena->used += size;
+    return object;
+}
+
+/**
+ * Release every object in an arena at once.
+ * @param arena is the arena to reset.
+ */
+void reset_arena (arena_t *arena)
+{
+    arena->used = 0;
+}
+
+/**
+ * Free the memory block of an arena.
+ * @param arena is the arena to free.
+ */
+void free_arena (arena_t *arena)
+{
+    free (arena->memory);
+    arena->memory = NULL;
+    arena->size = arena->used = 0;
+}
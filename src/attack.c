@@ -17,33 +17,202 @@
 
 /* project headers */
 #include "attack.h"
-#include "fatal.h"
-#include "barony.h"
+#include "game.h"
+#include "hash.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+/**
+ * Find where an attack is, or would be, in its origin's chain.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ * @return the link pointing at the attack or its successor.
+ */
+static int *find_attack (game_t *game, int o, int t)
+{
+    int *link; /* link to the attack being examined */
+    link = &game->first_attack[o];
+    while (*link != -1 && game->attacks[*link].target < t)
+	link = &game->attacks[*link].next;
+    return link;
+}
+
+/**
+ * Withdraw an attack's forces from its origin's committed totals.
+ * @param game is the game in progress.
+ * @param attack is the attack whose forces are withdrawn.
+ */
+static void withdraw_forces (game_t *game, attack_t *attack)
+{
+    game->committed_knights[attack->origin] -= attack->knights;
+    game->committed_footmen[attack->origin] -= attack->footmen;
+}
 
 /*----------------------------------------------------------------------
  * Public Functions.
  */
 
 /**
- * Create a new attack.
- * @return a pointer to the attack.
+ * Create or replace an attack.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ * @param knights is the number of knights sent.
+ * @param footmen is the number of footmen sent.
+ * @return a pointer to the attack, or NULL if the pool is full.
  */
-attack_t *new_attack (barony_t *origin, barony_t *target, int knights,
-		     int footmen)
+attack_t *new_attack (game_t *game, int o, int t, int knights,
+		      int footmen)
 {
     /* local variables */
-    attack_t *attack; /* the attack to create */
+    int *link, /* link to the attack's place in the chain */
+	a; /* index of the attack record */
+    attack_t *attack; /* the attack to fill in */
+
+    /* find an existing attack and withdraw its forces... */
+    if ((attack = get_attack (game, o, t))) {
+	withdraw_forces (game, attack);
+	if (game->hashing)
+	    game->hash ^= attack_key (attack);
+    }
 
-    /* attempt to allocate memory */
-    if (! (attack = malloc (sizeof (attack_t))))
-	fatal_error (FATAL_MEMORY);
+    /* ...or give the new attack its place in a dense pool... */
+    else if (DENSE_ATTACKS (game)) {
+	attack = &game->attacks[DENSE_ATTACK (o, t)];
+	attack->origin = o;
+	attack->target = t;
+	game->attack_mask |= ATTACK_BIT (o, t);
+    }
 
-    /* put in the attack details */
-    attack->origin = origin;
-    attack->target = target;
+    /* ...or take a free record and chain it in */
+    else {
+	if ((a = game->free_attack) != -1)
+	    game->free_attack = game->attacks[a].next;
+	else if (game->attacks_used < game->attack_capacity)
+	    a = game->attacks_used++;
+	else
+	    return NULL;
+	link = find_attack (game, o, t);
+	attack = &game->attacks[a];
+	attack->origin = o;
+	attack->target = t;
+	attack->next = *link;
+	*link = a;
+    }
+
+    /* put in the attack details, commit them and return the attack */
     attack->knights = knights;
     attack->footmen = footmen;
-
-    /* return the attack */
+    game->committed_knights[o] += knights;
+    game->committed_footmen[o] += footmen;
+    if (game->hashing)
+	game->hash ^= attack_key (attack);
     return attack;
 }
+
+/**
+ * Get an attack if there is one.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ * @return a pointer to the attack, or NULL if there is none.
+ */
+attack_t *get_attack (game_t *game, int o, int t)
+{
+    int a; /* index of the attack record */
+    if (DENSE_ATTACKS (game))
+	return game->attack_mask & ATTACK_BIT (o, t)
+	    ? &game->attacks[DENSE_ATTACK (o, t)]
+	    : NULL;
+    a = *find_attack (game, o, t);
+    if (a != -1 && game->attacks[a].target == t)
+	return &game->attacks[a];
+    return NULL;
+}
+
+/**
+ * Cancel an attack.
+ * @param game is the game in progress.
+ * @param o is the barony originating the attack.
+ * @param t is the target barony.
+ */
+void cancel_attack (game_t *game, int o, int t)
+{
+    int *link, /* link to the attack's place in the chain */
+	a; /* index of the attack record */
+    if (DENSE_ATTACKS (game)) {
+	if (game->attack_mask & ATTACK_BIT (o, t)) {
+	    withdraw_forces (game, &game->attacks[DENSE_ATTACK (o, t)]);
+	    if (game->hashing)
+		game->hash ^= attack_key
+		    (&game->attacks[DENSE_ATTACK (o, t)]);
+	    game->attack_mask &= ~ATTACK_BIT (o, t);
+	}
+	return;
+    }
+    link = find_attack (game, o, t);
+    if ((a = *link) != -1 && game->attacks[a].target == t) {
+	withdraw_forces (game, &game->attacks[a]);
+	if (game->hashing)
+	    game->hash ^= attack_key (&game->attacks[a]);
+	*link = game->attacks[a].next;
+	game->attacks[a].next = game->free_attack;
+	game->free_attack = a;
+    }
+}
+
+/**
+ * Cancel all attacks.
+ * The state hash is left alone: the caller accounts for any attacks
+ * that were still in it.
+ * @param game is the game in progress.
+ */
+void clear_attacks (game_t *game)
+{
+    int b; /* barony counter */
+    for (b = 0; b < game->barony_count; ++b) {
+	game->first_attack[b] = -1;
+	game->committed_knights[b] = 0;
+	game->committed_footmen[b] = 0;
+    }
+    game->attack_mask = 0;
+    game->attacks_used = 0;
+    game->free_attack = -1;
+}
+
+/**
+ * Find the lowest attack in an occupancy mask.
+ * @param mask is a non-zero occupancy mask.
+ * @return the bit number of the lowest attack.
+ */
+int lowest_attack (unsigned long long int mask)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll (mask);
+#else
+    int bit; /* bit counter */
+    for (bit = 0; ! (mask & 1); ++bit)
+	mask >>= 1;
+    return bit;
+#endif
+}
+
+/**
+ * Find the highest attack in an occupancy mask.
+ * @param mask is a non-zero occupancy mask.
+ * @return the bit number of the highest attack.
+ */
+int highest_attack (unsigned long long int mask)
+{
+#ifdef __GNUC__
+    return 63 - __builtin_clzll (mask);
+#else
+    int bit; /* bit counter */
+    for (bit = 63; ! (mask & (1ULL << 63)); --bit)
+	mask <<= 1;
+    return bit;
+#endif
+}
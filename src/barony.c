@@ -11,6 +11,7 @@
  */
 
 /* standard C headers */
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,25 +21,35 @@
 #include "anarchic.h"
 #include "fatal.h"
 
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var field_offsets are the places of the changing fields. */
+static size_t field_offsets[BARONY_FIELDS] = {
+    offsetof (barony_t, land),
+    offsetof (barony_t, population),
+    offsetof (barony_t, gold),
+    offsetof (barony_t, castles),
+    offsetof (barony_t, knights),
+    offsetof (barony_t, footmen),
+    offsetof (barony_t, ranking)
+};
+
 /*----------------------------------------------------------------------
  * Public Level Routines.
  */
 
 /**
- * Create an intialise a new barony.
+ * Initialise a barony held by value in a game.
+ * @param barony is the barony to initialise.
  * @param name is a name for the barony.
- * @return a pointer to the new barony.
  */
-barony_t *new_barony (char *name) {
-
-    /* local variables */
-    barony_t *barony; /* the locally created barony to return */
+void init_barony (barony_t *barony, char *name) {
 
-    /* validation and memory reservation */
-    if (! name || strlen (name) > 10)
+    /* validation */
+    if (! name || strlen (name) > NAME_LENGTH)
 	fatal_error (FATAL_STRING);
-    if (! (barony = malloc (sizeof (barony_t))))
-	fatal_error (FATAL_MEMORY);
 
     /* initialise the values */
     strcpy (barony->name, name);
@@ -51,7 +62,15 @@ barony_t *new_barony (char *name) {
     barony->footmen = 4000;
     barony->ranking = 1;
 
-    /* return the new barony */
-    return barony;
-    
+}
+
+/**
+ * Get one of the fields of a barony that change in play.
+ * @param barony is the barony.
+ * @param field is the field wanted.
+ * @return a pointer to the field.
+ */
+int *barony_field (barony_t *barony, barony_field_t field)
+{
+    return (int *) ((char *) barony + field_offsets[field]);
 }
@@ -0,0 +1,362 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Multi-Threaded Batch Runner Module.
+ * Spreads all-computer games over many threads with work stealing,
+ * and reports how well the throughput scales with the thread count.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX headers */
+#include <pthread.h>
+#include <unistd.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "hash.h"
+#include "report.h"
+#include "fatal.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_GAMES is the number of games played by default. */
+#define DEFAULT_GAMES 100000
+
+/** @const CHUNK is the number of games in a unit of work. */
+#define CHUNK 16
+
+/* typedefs */
+typedef struct deque deque_t;
+typedef struct result result_t;
+typedef struct worker worker_t;
+
+/** @struct deque is a double-ended queue of work for one thread. */
+struct deque {
+
+    /** @var lock serialises access between owner and thieves. */
+    pthread_mutex_t lock;
+
+    /** @var chunks are the first game numbers of each chunk. */
+    long int *chunks;
+
+    /** @var top is the end that thieves steal from. */
+    long int top;
+
+    /** @var bottom is the end that the owner works from. */
+    long int bottom;
+
+};
+
+/** @struct result accumulates the outcome of many games. */
+struct result {
+
+    /** @var games is the number of games played. */
+    long int games;
+
+    /** @var turns is the number of turns processed. */
+    long int turns;
+
+    /** @var steals is the number of chunks stolen. */
+    long int steals;
+
+    /** @var checksum is the sum of per-game state checksums. */
+    unsigned long int checksum;
+
+    /** @var wins are the first places taken by each barony. */
+    long int wins[BARONIES];
+
+    /** @var land is the total final land of each barony. */
+    double land[BARONIES];
+
+};
+
+/** @struct worker is the state of one worker thread. */
+struct worker {
+
+    /** @var id is the worker's index. */
+    int id;
+
+    /** @var thread is the POSIX thread running the worker. */
+    pthread_t thread;
+
+    /** @var deque is the worker's own queue of work. */
+    deque_t deque;
+
+    /** @var result is the worker's private accumulator. */
+    result_t result;
+
+};
+
+/** @var workers are the worker threads for the current run. */
+static worker_t *workers;
+
+/** @var threads is the number of worker threads in the current run. */
+static int threads;
+
+/** @var games is the number of games to play in each run. */
+static long int games;
+
+/** @var seed is the seed of the first game. */
+static unsigned long int seed;
+
+/*----------------------------------------------------------------------
+ * Level 2 Routines.
+ */
+
+/**
+ * Play a single all-computer game and add it to a result.
+ * @param game_seed is the random number seed for the game.
+ * @param result is the accumulator to add the game to.
+ */
+static void play_game (unsigned long int game_seed, result_t *result)
+{
+    game_t *game; /* the game to play */
+    int b; /* barony counter */
+
+    /* play every turn of the game */
+    game = new_game (BARONIES);
+    seed_game (game, game_seed);
+    game->report_policy = REPORT_NONE;
+    while (game->turn < TURNS) {
+	computer_turns (game);
+	process_turn (game);
+	++result->turns;
+    }
+
+    /* accumulate the outcome */
+    ++result->games;
+    result->checksum
+	= (result->checksum + checksum_game (0, game)) & 0xffffffffUL;
+    for (b = 0; b < BARONIES; ++b) {
+	if (game->baronies[b].ranking == 1)
+	    ++result->wins[b];
+	result->land[b] += game->baronies[b].land;
+    }
+    end_game (game);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Take a chunk from the owner's end of a deque.
+ * @param deque is the deque to take from.
+ * @param chunk receives the first game of the chunk.
+ * @return 1 if a chunk was taken, 0 if the deque was empty.
+ */
+static int pop_chunk (deque_t *deque, long int *chunk)
+{
+    int found; /* 1 if a chunk was found */
+    pthread_mutex_lock (&deque->lock);
+    if ((found = deque->bottom > deque->top))
+	*chunk = deque->chunks[--deque->bottom];
+    pthread_mutex_unlock (&deque->lock);
+    return found;
+}
+
+/**
+ * Steal a chunk from the far end of another worker's deque.
+ * @param deque is the deque to steal from.
+ * @param chunk receives the first game of the chunk.
+ * @return 1 if a chunk was stolen, 0 if the deque was empty.
+ */
+static int steal_chunk (deque_t *deque, long int *chunk)
+{
+    int found; /* 1 if a chunk was found */
+    pthread_mutex_lock (&deque->lock);
+    if ((found = deque->bottom > deque->top))
+	*chunk = deque->chunks[deque->top++];
+    pthread_mutex_unlock (&deque->lock);
+    return found;
+}
+
+/**
+ * Worker thread: play own chunks, then steal until none are left.
+ * Work is never added once a run starts, so a full round of failed
+ * steals means that every chunk has been taken.
+ * @param arg points to the worker's state.
+ * @return NULL.
+ */
+static void *work (void *arg)
+{
+    worker_t *worker; /* this worker */
+    long int chunk, /* first game of the current chunk */
+	g; /* game counter */
+    int v, /* victim counter */
+	found; /* 1 if a chunk was found */
+
+    /* main loop */
+    worker = arg;
+    do {
+
+	/* take work from our own deque, or steal it */
+	found = pop_chunk (&worker->deque, &chunk);
+	for (v = 1; ! found && v < threads; ++v)
+	    if ((found = steal_chunk
+		 (&workers[(worker->id + v) % threads].deque, &chunk)))
+		++worker->result.steals;
+
+	/* play the chunk */
+	if (found)
+	    for (g = chunk; g < chunk + CHUNK && g < games; ++g)
+		play_game (seed + g, &worker->result);
+
+    } while (found);
+    return NULL;
+}
+
+/**
+ * Get the wall clock time in seconds.
+ * @return the time in seconds.
+ */
+static double wall_clock (void)
+{
+    struct timespec now; /* current time */
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Play all the games with a given number of threads.
+ * @param count is the number of threads to use.
+ * @param total receives the merged result.
+ * @return the wall clock time taken in seconds.
+ */
+static double run (int count, result_t *total)
+{
+    long int chunks, /* number of chunks of work */
+	c; /* chunk counter */
+    int w, /* worker counter */
+	b; /* barony counter */
+    double start; /* time at the start of the run */
+    deque_t *deque; /* shorthand pointer to a deque */
+
+    /* create the workers and deal the chunks round-robin */
+    threads = count;
+    if (! (workers = calloc (threads, sizeof (worker_t))))
+	fatal_error (FATAL_MEMORY);
+    chunks = (games + CHUNK - 1) / CHUNK;
+    for (w = 0; w < threads; ++w) {
+	workers[w].id = w;
+	deque = &workers[w].deque;
+	pthread_mutex_init (&deque->lock, NULL);
+	if (! (deque->chunks = malloc
+	       ((chunks / threads + 1) * sizeof (long int))))
+	    fatal_error (FATAL_MEMORY);
+    }
+    for (c = 0; c < chunks; ++c) {
+	deque = &workers[c % threads].deque;
+	deque->chunks[deque->bottom++] = c * CHUNK;
+    }
+
+    /* run the workers */
+    start = wall_clock ();
+    for (w = 0; w < threads; ++w)
+	pthread_create (&workers[w].thread, NULL, work, &workers[w]);
+    for (w = 0; w < threads; ++w)
+	pthread_join (workers[w].thread, NULL);
+    start = wall_clock () - start;
+
+    /* merge the per-thread results and clean up */
+    memset (total, 0, sizeof (result_t));
+    for (w = 0; w < threads; ++w) {
+	total->games += workers[w].result.games;
+	total->turns += workers[w].result.turns;
+	total->steals += workers[w].result.steals;
+	total->checksum = (total->checksum + workers[w].result.checksum)
+	    & 0xffffffffUL;
+	for (b = 0; b < BARONIES; ++b) {
+	    total->wins[b] += workers[w].result.wins[b];
+	    total->land[b] += workers[w].result.land[b];
+	}
+	pthread_mutex_destroy (&workers[w].deque.lock);
+	free (workers[w].deque.chunks);
+    }
+    free (workers);
+    return start;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The batch runner has no display, but the fatal error handler
+ * expects one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    int max, /* maximum number of threads */
+	count, /* thread count for a run */
+	b; /* barony counter */
+    double seconds, /* time taken for a run */
+	single; /* time taken with one thread */
+    result_t total; /* merged result of a run */
+
+    /* get the parameters from the command line */
+    games = argc > 1 ? atol (argv[1]) : DEFAULT_GAMES;
+    max = argc > 2 ? atoi (argv[2]) : (int) sysconf (_SC_NPROCESSORS_ONLN);
+    seed = argc > 3 ? strtoul (argv[3], NULL, 10) : 1;
+    if (games <= 0 || max <= 0) {
+	fprintf (stderr, "Usage: %s [games] [threads] [seed]\n", argv[0]);
+	return 1;
+    }
+
+    /* run with doubling thread counts up to the maximum */
+    single = 0;
+    printf ("threads   seconds   games/second   speedup   efficiency"
+	    "   steals   checksum\n");
+    count = 1;
+    do {
+	seconds = run (count, &total);
+	if (count == 1)
+	    single = seconds;
+	printf ("%7d %9.3f %14.1f %9.2f %11.1f%% %8ld   %08lx\n",
+		count, seconds, total.games / seconds, single / seconds,
+		100.0 * single / seconds / count, total.steals,
+		total.checksum);
+	if (count < max)
+	    count = count * 2 < max ? count * 2 : max;
+	else
+	    count = 0;
+    } while (count);
+
+    /* show the outcome of the last run */
+    printf ("\nbarony       wins   mean land\n");
+    for (b = 0; b < BARONIES; ++b)
+	printf ("%d %14ld %11.1f\n", b + 1, total.wins[b],
+		total.land[b] / total.games);
+    return 0;
+}
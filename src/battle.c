@@ -0,0 +1,326 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Battle Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "battle.h"
+#include "report.h"
+#include "rules.h"
+
+/*----------------------------------------------------------------------
+ * Level 3 Private Functions.
+ */
+
+/**
+ * Scale a value by a fraction in integer arithmetic, rounding down.
+ * The product is formed before dividing, so results that are exact
+ * stay exact, and every compiler gives the same answer. Small values
+ * multiply within 32 bits; larger ones fall back to 64 bits.
+ * @param value is the value to scale.
+ * @param part is the numerator of the fraction.
+ * @param whole is the non-zero denominator of the fraction.
+ * @return value * part / whole.
+ */
+static unsigned long int integer_scale (unsigned long int value,
+					unsigned long int part,
+					unsigned long int whole)
+{
+    if (value < 0x10000UL && part < 0x10000UL)
+	return value * part / whole;
+    return (unsigned long int)
+	((unsigned long long int) value * part / whole);
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Private Functions.
+ */
+
+/**
+ * Work out the outcome of a battle that is joined, in integers.
+ * @param battle is the battle.
+ * @param knight_value is the worth of a knight in footmen.
+ * @param castle_value is the worth of a castle in footmen.
+ */
+static void integer_outcome (battle_t *battle,
+			     unsigned long int knight_value,
+			     unsigned long int castle_value)
+{
+    /* local variables */
+    unsigned long int
+	knights, /* total attacking knights */
+	footmen, /* total attacking footmen */
+	attack, /* total attacking force value */
+	whole, /* total force value on both sides */
+	castles_beaten; /* number of castles taken or razed */
+
+    /* calculate losses on both sides */
+    knights = battle->knights;
+    footmen = battle->footmen;
+    attack = battle->attack;
+    whole = attack + battle->castles * castle_value + battle->defenders;
+    battle->land_taken = integer_scale (battle->land, attack, whole);
+    battle->gold_looted = integer_scale (battle->gold, attack, whole);
+    castles_beaten = integer_scale (battle->castles, attack, whole);
+    battle->castles_taken = knights + footmen / knight_value
+	? integer_scale (castles_beaten, knights,
+			 knights + footmen / knight_value)
+	: 0;
+    battle->castles_razed = castles_beaten - battle->castles_taken;
+    battle->footmen_slain
+	= integer_scale (battle->defenders, attack, whole);
+    battle->knights_lost
+	= integer_scale (knights, whole - attack, whole);
+    battle->footmen_lost
+	= integer_scale (footmen, whole - attack, whole);
+}
+
+/**
+ * Work out the outcome of a battle that is joined, in floating point.
+ * @param battle is the battle.
+ * @param knight_value is the worth of a knight in footmen.
+ * @param castle_value is the worth of a castle in footmen.
+ */
+static void float_outcome (battle_t *battle,
+			   unsigned long int knight_value,
+			   unsigned long int castle_value)
+{
+    /* local variables */
+    unsigned long int
+	knights, /* total attacking knights */
+	footmen, /* total attacking footmen */
+	attack, /* total attacking force value */
+	defence, /* total defending force value */
+	castles_beaten; /* number of castles taken or razed */
+    float att_loss, /* proportion of attackers lost */
+	def_loss; /* proportion of defenders lost */
+
+    /* calculate losses on both sides */
+    knights = battle->knights;
+    footmen = battle->footmen;
+    attack = battle->attack;
+    defence = battle->castles * castle_value + battle->defenders;
+    att_loss = (float) defence / (attack + defence);
+    def_loss = (float) attack / (attack + defence);
+    battle->land_taken = def_loss * battle->land;
+    battle->gold_looted = def_loss * battle->gold;
+    castles_beaten = def_loss * battle->castles;
+    battle->castles_taken
+	= (knights / (float) (knights + footmen / knight_value))
+	* castles_beaten;
+    battle->castles_razed = castles_beaten - battle->castles_taken;
+    battle->footmen_slain = def_loss * battle->defenders;
+    battle->knights_lost = att_loss * knights;
+    battle->footmen_lost = att_loss * footmen;
+}
+
+/**
+ * Clear the outcome of a battle with no attacking force.
+ * @param battle is the battle.
+ */
+static void no_outcome (battle_t *battle)
+{
+    battle->land_taken = battle->gold_looted = 0;
+    battle->castles_taken = battle->castles_razed = 0;
+    battle->footmen_slain = 0;
+    battle->knights_lost = battle->footmen_lost = 0;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+/**
+ * Predict the outcome of a battle with the units weighed as given.
+ * @param battle is the battle, as for predict_battle.
+ * @param math is the battle arithmetic.
+ * @param knight_value is the worth of a knight in footmen.
+ * @param castle_value is the worth of a castle in footmen.
+ * @return 1 if battle was joined, 0 if there was no attacking force.
+ */
+static int weigh_battle (battle_t *battle, battle_math_t math,
+			 unsigned long int knight_value,
+			 unsigned long int castle_value)
+{
+    battle->attack = battle->knights * knight_value + battle->footmen;
+    if (battle->attack == 0)
+	no_outcome (battle);
+    else if (math == MATH_INTEGER)
+	integer_outcome (battle, knight_value, castle_value);
+    else
+	float_outcome (battle, knight_value, castle_value);
+    return battle->attack != 0;
+}
+
+/**
+ * Predict the outcomes of many battles with the units weighed as
+ * given.
+ * @param battles are the battles, as for predict_battle.
+ * @param count is the number of battles.
+ * @param math is the battle arithmetic.
+ * @param knight_value is the worth of a knight in footmen.
+ * @param castle_value is the worth of a castle in footmen.
+ */
+static void weigh_battles (battle_t *battles, int count,
+			   battle_math_t math,
+			   unsigned long int knight_value,
+			   unsigned long int castle_value)
+{
+    /* local variables */
+    battle_t *battle, /* the battle being predicted */
+	*end; /* the end of the battles */
+
+    /* work through the battles with the arithmetic chosen */
+    end = battles + count;
+    if (math == MATH_INTEGER)
+	for (battle = battles; battle < end; ++battle) {
+	    battle->attack
+		= battle->knights * knight_value + battle->footmen;
+	    if (battle->attack)
+		integer_outcome (battle, knight_value, castle_value);
+	    else
+		no_outcome (battle);
+	}
+    else
+	for (battle = battles; battle < end; ++battle) {
+	    battle->attack
+		= battle->knights * knight_value + battle->footmen;
+	    if (battle->attack)
+		float_outcome (battle, knight_value, castle_value);
+	    else
+		no_outcome (battle);
+	}
+}
+
+/**
+ * Work out one attacker's share of a battle with the units weighed
+ * as given.
+ * @param share receives the gains and losses of the attacker.
+ * @param battle is the outcome of a battle that was joined.
+ * @param knights is the number of knights the attacker sent.
+ * @param footmen is the number of footmen the attacker sent.
+ * @param math is the battle arithmetic.
+ * @param knight_value is the worth of a knight in footmen.
+ */
+static void weigh_share (attack_report_t *share, battle_t *battle,
+			 int knights, int footmen, battle_math_t math,
+			 unsigned long int knight_value)
+{
+    /* local variables */
+    unsigned long int value; /* value of the attacker's part */
+    float knights_part, /* proportion of knights sent by the attacker */
+	footmen_part, /* proportion of footmen sent by the attacker */
+	attack_part; /* proportion of the attacker's part of attack */
+
+    /* share out the results in integers... */
+    if (math == MATH_INTEGER) {
+	value = knights * knight_value + footmen;
+	share->land_taken
+	    = integer_scale (battle->land_taken, value, battle->attack);
+	share->gold_looted = battle->footmen
+	    ? integer_scale (battle->gold_looted, footmen,
+			     battle->footmen)
+	    : 0;
+	share->castles_taken = integer_scale
+	    (battle->castles_taken, value, battle->attack);
+	share->castles_razed = integer_scale
+	    (battle->castles_razed, value, battle->attack);
+	share->footmen_slain = integer_scale
+	    (battle->footmen_slain, value, battle->attack);
+	share->knights_lost = battle->knights
+	    ? integer_scale (battle->knights_lost, knights,
+			     battle->knights)
+	    : 0;
+	share->footmen_lost = battle->footmen
+	    ? integer_scale (battle->footmen_lost, footmen,
+			     battle->footmen)
+	    : 0;
+    }
+
+    /* ...or in floating point */
+    else {
+	knights_part = battle->knights
+	    ? (float) knights / battle->knights
+	    : 0;
+	footmen_part = battle->footmen
+	    ? (float) footmen / battle->footmen
+	    : 0;
+	attack_part = (float) (knights * knight_value + footmen)
+	    / battle->attack;
+	share->land_taken = attack_part * battle->land_taken;
+	share->gold_looted = footmen_part * battle->gold_looted;
+	share->castles_taken = attack_part * battle->castles_taken;
+	share->castles_razed = attack_part * battle->castles_razed;
+	share->footmen_slain = attack_part * battle->footmen_slain;
+	share->knights_lost = knights_part * battle->knights_lost;
+	share->footmen_lost = footmen_part * battle->footmen_lost;
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Predict the outcome of a battle.
+ * @param battle holds the forces and the defender, and receives the
+ * outcome; an outcome with no attacking force is all zeros.
+ * @param math is the battle arithmetic.
+ * @param rules are the rules of the game, or NULL for the stock rules.
+ * @return 1 if battle was joined, 0 if there was no attacking force.
+ */
+int predict_battle (battle_t *battle, battle_math_t math,
+		    ruleset_t *rules)
+{
+    if (rules)
+	return weigh_battle (battle, math, rules->knight_value,
+			     rules->castle_value);
+    return weigh_battle (battle, math, KNIGHT_VALUE, CASTLE_VALUE);
+}
+
+/**
+ * Predict the outcomes of many battles at once.
+ * @param battles are the battles, as for predict_battle.
+ * @param count is the number of battles.
+ * @param math is the battle arithmetic.
+ * @param rules are the rules of the game, or NULL for the stock rules.
+ */
+void predict_battles (battle_t *battles, int count, battle_math_t math,
+		      ruleset_t *rules)
+{
+    if (rules)
+	weigh_battles (battles, count, math, rules->knight_value,
+		       rules->castle_value);
+    else
+	weigh_battles (battles, count, math, KNIGHT_VALUE,
+		       CASTLE_VALUE);
+}
+
+/**
+ * Work out one attacker's share of the outcome of a battle.
+ * @param share receives the gains and losses of the attacker.
+ * @param battle is the outcome of a battle that was joined.
+ * @param knights is the number of knights the attacker sent.
+ * @param footmen is the number of footmen the attacker sent.
+ * @param math is the battle arithmetic.
+ * @param rules are the rules of the game, or NULL for the stock rules.
+ */
+void share_battle (attack_report_t *share, battle_t *battle,
+		   int knights, int footmen, battle_math_t math,
+		   ruleset_t *rules)
+{
+    weigh_share (share, battle, knights, footmen, math,
+		 rules ? rules->knight_value : KNIGHT_VALUE);
+}
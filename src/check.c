@@ -0,0 +1,557 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Self-Check Module.
+ * Plays seeded all-computer games with reports, and checks every
+ * turn against the library's other ways of working it out: the turn
+ * undone must match a copy of the game taken before it, and done
+ * again must match the first time; evaluate_candidates must agree
+ * with process_turn on a copy of the game; predict_battles must
+ * agree with the battles fought; and the observer must be told of
+ * what the reports hold. Odd games use floating point arithmetic.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "barony.h"
+#include "order.h"
+#include "attack.h"
+#include "report.h"
+#include "battle.h"
+#include "observer.h"
+#include "delta.h"
+#include "hash.h"
+#include "random.h"
+#include "fatal.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_GAMES is the number of games played by default. */
+#define DEFAULT_GAMES 1000
+
+/** @const CANDIDATES is the number of candidates tried each turn. */
+#define CANDIDATES 3
+
+/** @enum check_t enumerates the checks made. */
+typedef enum {
+    CHECK_UNDO, /* undo_turn and redoing the turn */
+    CHECK_CANDIDATES, /* evaluate_candidates against process_turn */
+    CHECK_PREDICT, /* predict_battles against the battles fought */
+    CHECK_OBSERVER, /* the observer's events against the reports */
+    CHECKS
+} check_t;
+
+/* typedefs */
+typedef struct tally tally_t;
+
+/** @struct tally is what the observer has been told of a turn. */
+struct tally {
+
+    /** @var battles are the outcomes of the battles fought. */
+    battle_t *battles;
+
+    /** @var targets are the baronies the battles were fought at. */
+    int *targets;
+
+    /** @var battle_count is the number of battles fought. */
+    int battle_count;
+
+    /** @var shares is the number of attackers' shares. */
+    long int shares;
+
+    /** @var land is the land taken by all the attackers. */
+    long int land;
+
+    /** @var delivered is the number of orders delivered. */
+    long int delivered;
+
+    /** @var undelivered is the number of orders not delivered. */
+    long int undelivered;
+
+    /** @var migrations is the number of migrations. */
+    long int migrations;
+
+    /** @var migration is the total change in population. */
+    long int migration;
+
+    /** @var tax is the total tax raised. */
+    long int tax;
+
+    /** @var desertions is the number of baronies deserted. */
+    long int desertions;
+
+};
+
+/** @var check_names are the names of the checks. */
+static char *check_names[] = {
+    "undo_turn",
+    "evaluate_candidates",
+    "predict_battles",
+    "observer"
+};
+
+/** @var tested is the number of times each check was made. */
+static unsigned long int tested[CHECKS];
+
+/** @var failed is the number of times each check failed. */
+static unsigned long int failed[CHECKS];
+
+/** @var rng chooses the baronies whose candidates are tried. */
+static random_t rng;
+
+/*----------------------------------------------------------------------
+ * Level 3 Routines.
+ */
+
+/**
+ * Tally the share of a battle, noting each battle as a whole.
+ * @param observer is the observer.
+ * @param game is the game.
+ * @param origin is the attacker.
+ * @param target is the barony attacked.
+ * @param share is the attacker's share.
+ * @param outcome is the battle as a whole.
+ */
+static void observe_battle (observer_t *observer, game_t *game,
+			    int origin, int target,
+			    attack_report_t *share, battle_t *outcome)
+{
+    tally_t *tally; /* the tally to add to */
+    tally = observer->data;
+    ++tally->shares;
+    tally->land += share->land_taken;
+    if (! tally->battle_count
+	|| tally->targets[tally->battle_count - 1] != target) {
+	tally->targets[tally->battle_count] = target;
+	tally->battles[tally->battle_count++] = *outcome;
+    }
+}
+
+/**
+ * Tally an order placed.
+ * @param observer is the observer.
+ * @param game is the game.
+ * @param b is the barony.
+ * @param order is the order.
+ * @param delivered is 1 if it was delivered.
+ */
+static void observe_delivery (observer_t *observer, game_t *game,
+			      int b, order_t *order, int delivered)
+{
+    tally_t *tally; /* the tally to add to */
+    tally = observer->data;
+    if (delivered)
+	++tally->delivered;
+    else
+	++tally->undelivered;
+}
+
+/**
+ * Tally a barony's migration and tax.
+ * @param observer is the observer.
+ * @param game is the game.
+ * @param b is the barony.
+ * @param migration is the change in population.
+ * @param tax is the tax raised.
+ */
+static void observe_migration (observer_t *observer, game_t *game,
+			       int b, int migration, int tax)
+{
+    tally_t *tally; /* the tally to add to */
+    tally = observer->data;
+    ++tally->migrations;
+    tally->migration += migration;
+    tally->tax += tax;
+}
+
+/**
+ * Tally a barony deserted by units it could not pay for.
+ * @param observer is the observer.
+ * @param game is the game.
+ * @param b is the barony.
+ * @param castles are the castles lost.
+ * @param knights are the knights lost.
+ * @param footmen are the footmen lost.
+ */
+static void observe_desertion (observer_t *observer, game_t *game,
+			       int b, int castles, int knights,
+			       int footmen)
+{
+    tally_t *tally; /* the tally to add to */
+    tally = observer->data;
+    ++tally->desertions;
+}
+
+/**
+ * Clear a tally for a new turn, keeping its battle space.
+ * @param tally is the tally to clear.
+ */
+static void clear_tally (tally_t *tally)
+{
+    tally->battle_count = 0;
+    tally->shares = tally->land = 0;
+    tally->delivered = tally->undelivered = 0;
+    tally->migrations = tally->migration = tally->tax = 0;
+    tally->desertions = 0;
+}
+
+/**
+ * See whether a game is in the same state as another.
+ * @param game is the game.
+ * @param other is the other game.
+ * @return 1 if it is, 0 if not.
+ */
+static int same_state (game_t *game, game_t *other)
+{
+    int b, /* barony counter */
+	f; /* generator word counter */
+    if (game->turn != other->turn
+	|| calculate_hash (game) != calculate_hash (other)
+	|| (game->hashing && game->hash != calculate_hash (game)))
+	return 0;
+    for (f = 0; f < 4; ++f)
+	if (game->rng.state[f] != other->rng.state[f])
+	    return 0;
+    for (b = 0; b < game->barony_count; ++b)
+	if (game->ranks[b].barony != other->ranks[b].barony
+	    || game->ranks[b].land != other->ranks[b].land
+	    || game->committed_knights[b] != other->committed_knights[b]
+	    || game->committed_footmen[b]
+	    != other->committed_footmen[b])
+	    return 0;
+    return 1;
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Routines.
+ */
+
+/**
+ * Try some candidates for a barony, and check each against the turn
+ * processed on a copy of the game with the candidate placed.
+ * @param game is the game, with its orders and attacks placed.
+ * @param scratch is a game of the same size to work on.
+ * @param attacks is room for CANDIDATES times the baronies attacks.
+ */
+static void check_candidates (game_t *game, game_t *scratch,
+			      attack_t *attacks)
+{
+    /* local variables */
+    int b, /* the barony whose candidates are tried */
+	t, /* target counter */
+	c, /* candidate counter */
+	a, /* attack counter */
+	count; /* number of attacks the barony has placed */
+    candidate_t candidates[CANDIDATES]; /* the candidates */
+    order_t orders[CANDIDATES], /* the candidates' orders */
+	*order; /* the order the barony has placed */
+    summary_t summaries[CANDIDATES]; /* what each candidate did */
+    attack_t *attack; /* shorthand pointer to an attack */
+    barony_t *barony; /* the barony after the turn */
+    hash_t hash; /* the game's hash before evaluation */
+
+    /* the first candidate is what the barony has placed */
+    b = random_number (&rng, game->barony_count);
+    for (count = t = 0; t < game->barony_count; ++t)
+	if ((attack = get_attack (game, b, t)))
+	    attacks[count++] = *attack;
+    order = get_order (game, b);
+    if (order)
+	orders[0] = *order;
+    candidates[0].order = order ? &orders[0] : NULL;
+    candidates[0].attacks = attacks;
+    candidates[0].attack_count = count;
+
+    /* the second places nothing at all */
+    candidates[1].order = NULL;
+    candidates[1].attacks = NULL;
+    candidates[1].attack_count = 0;
+
+    /* the third orders and sends half as much */
+    orders[2] = orders[0];
+    orders[2].castles /= 2;
+    orders[2].knights /= 2;
+    orders[2].footmen /= 2;
+    candidates[2].order = order ? &orders[2] : NULL;
+    candidates[2].attacks = attacks + 2 * game->barony_count;
+    candidates[2].attack_count = count;
+    for (a = 0; a < count; ++a) {
+	candidates[2].attacks[a] = attacks[a];
+	candidates[2].attacks[a].knights /= 2;
+	candidates[2].attacks[a].footmen /= 2;
+    }
+
+    /* evaluate them, which must leave the game as it was */
+    hash = calculate_hash (game);
+    evaluate_candidates (game, b, candidates, CANDIDATES, summaries);
+    ++tested[CHECK_CANDIDATES];
+    if (calculate_hash (game) != hash)
+	++failed[CHECK_CANDIDATES];
+
+    /* play each candidate on a copy of the game */
+    for (c = 0; c < CANDIDATES; ++c) {
+	game_copy_into (scratch, game);
+	cancel_order (scratch, b);
+	for (t = 0; t < scratch->barony_count; ++t)
+	    if (get_attack (scratch, b, t))
+		cancel_attack (scratch, b, t);
+	if (candidates[c].order)
+	    set_order (scratch, b, candidates[c].order->castles,
+		       candidates[c].order->knights,
+		       candidates[c].order->footmen);
+	for (a = 0; a < candidates[c].attack_count; ++a)
+	    new_attack (scratch, b, candidates[c].attacks[a].target,
+			candidates[c].attacks[a].knights,
+			candidates[c].attacks[a].footmen);
+	process_turn (scratch);
+	barony = &scratch->baronies[b];
+	++tested[CHECK_CANDIDATES];
+	if (barony->land != summaries[c].land
+	    || barony->population != summaries[c].population
+	    || barony->gold != summaries[c].gold
+	    || barony->castles != summaries[c].castles
+	    || barony->knights != summaries[c].knights
+	    || barony->footmen != summaries[c].footmen)
+	    ++failed[CHECK_CANDIDATES];
+    }
+}
+
+/**
+ * Predict the battles the observer was told of, from their forces
+ * and defenders alone, and check the outcomes against them.
+ * @param game is the game, after its turn.
+ * @param tally is what the observer was told.
+ */
+static void check_predictions (game_t *game, tally_t *tally)
+{
+    int b; /* battle counter */
+    battle_t *battles, /* the battles to predict */
+	*battle; /* shorthand pointer to one of them */
+    if (! tally->battle_count)
+	return;
+    if (! (battles = calloc (tally->battle_count, sizeof (battle_t))))
+	fatal_error (FATAL_MEMORY);
+    for (b = 0; b < tally->battle_count; ++b) {
+	battle = &battles[b];
+	battle->knights = tally->battles[b].knights;
+	battle->footmen = tally->battles[b].footmen;
+	battle->castles = tally->battles[b].castles;
+	battle->defenders = tally->battles[b].defenders;
+	battle->land = tally->battles[b].land;
+	battle->gold = tally->battles[b].gold;
+    }
+    predict_battles (battles, tally->battle_count, game->battle_math,
+		     get_rules (game));
+    for (b = 0; b < tally->battle_count; ++b) {
+	++tested[CHECK_PREDICT];
+	if (memcmp (&battles[b], &tally->battles[b], sizeof (battle_t)))
+	    ++failed[CHECK_PREDICT];
+    }
+    free (battles);
+}
+
+/**
+ * Check what the observer was told of a turn against the reports.
+ * @param game is the game, after its turn.
+ * @param tally is what the observer was told.
+ */
+static void check_reports (game_t *game, tally_t *tally)
+{
+    int b; /* barony counter */
+    long int shares, /* number of attackers' shares reported */
+	land, /* land taken by all the attackers */
+	delivered, /* number of orders delivered */
+	undelivered, /* number of orders not delivered */
+	migration, /* total change in population */
+	tax, /* total tax raised */
+	desertions; /* number of baronies deserted */
+    report_t *report; /* shorthand pointer to a report */
+    attack_report_t *share; /* shorthand pointer to a share */
+
+    /* total what the reports hold */
+    shares = land = delivered = undelivered = 0;
+    migration = tax = desertions = 0;
+    for (b = 0; b < game->barony_count; ++b) {
+	if (! (report = game->reports[b]))
+	    continue;
+	for (share = report->attacks; share;
+	     share = share->next_attack) {
+	    ++shares;
+	    land += share->land_taken;
+	}
+	delivered += report->delivered != NULL;
+	undelivered += report->notdelivered != NULL;
+	migration += report->migration;
+	tax += report->tax;
+	desertions += report->attrition != NULL;
+    }
+
+    /* compare it with what the observer was told */
+    ++tested[CHECK_OBSERVER];
+    if (shares != tally->shares
+	|| land != tally->land
+	|| delivered != tally->delivered
+	|| undelivered != tally->undelivered
+	|| tally->migrations != game->barony_count
+	|| migration != tally->migration
+	|| tax != tally->tax
+	|| desertions != tally->desertions)
+	++failed[CHECK_OBSERVER];
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Play a single all-computer game, checking every turn.
+ * @param baronies is the number of baronies.
+ * @param seed is the random number seed for the game.
+ * @param math is the battle arithmetic.
+ */
+static void play_game (int baronies, unsigned long int seed,
+		       battle_math_t math)
+{
+    /* local variables */
+    game_t *game, /* the game to play */
+	*before, /* the game before each turn */
+	*scratch; /* a copy for trying candidates on */
+    delta_t *delta; /* the record of each turn */
+    attack_t *attacks; /* room for the candidates' attacks */
+    tally_t tally; /* what the observer is told */
+    observer_t observer = { /* the observer of each turn */
+	NULL,
+	observe_battle,
+	observe_delivery,
+	observe_migration,
+	observe_desertion
+    };
+    hash_t hash; /* the hash after the turn is first processed */
+
+    /* start the game, with reports for every barony */
+    game = new_game (baronies);
+    seed_game (game, seed);
+    game->report_policy = REPORT_ALL;
+    game->battle_math = math;
+    keep_hash (game, 1);
+    observer.data = &tally;
+    set_observer (game, &observer);
+    before = game_clone (game);
+    scratch = game_clone (game);
+    delta = new_delta (game);
+    if (! (attacks = malloc (CANDIDATES * baronies * sizeof (attack_t)))
+	|| ! (tally.battles = malloc (baronies * sizeof (battle_t)))
+	|| ! (tally.targets = malloc (baronies * sizeof (int))))
+	fatal_error (FATAL_MEMORY);
+
+    /* play every turn of the game */
+    while (game->turn < TURNS) {
+	computer_turns (game);
+	check_candidates (game, scratch, attacks);
+
+	/* process the turn, undo it, and process it again */
+	game_copy_into (before, game);
+	clear_tally (&tally);
+	process_turn_delta (game, delta);
+	hash = calculate_hash (game);
+	undo_turn (game, delta);
+	++tested[CHECK_UNDO];
+	if (! same_state (game, before))
+	    ++failed[CHECK_UNDO];
+	clear_tally (&tally);
+	process_turn_delta (game, delta);
+	++tested[CHECK_UNDO];
+	if (calculate_hash (game) != hash || game_hash (game) != hash)
+	    ++failed[CHECK_UNDO];
+
+	/* check what the observer was told of the second time */
+	check_predictions (game, &tally);
+	check_reports (game, &tally);
+    }
+
+    /* clean up */
+    free (tally.targets);
+    free (tally.battles);
+    free (attacks);
+    end_delta (delta);
+    end_game (scratch);
+    end_game (before);
+    end_game (game);
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The checker has no display, but the fatal error handler expects
+ * one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if every check passed, >0 on error or failure.
+ */
+int main (int argc, char **argv)
+{
+    unsigned long int seed; /* seed for the first game */
+    long int games, /* number of games to play */
+	g; /* game counter */
+    int baronies, /* number of baronies in each game */
+	c, /* check counter */
+	status; /* status to return */
+
+    /* get the parameters from the command line */
+    games = argc > 1 ? atol (argv[1]) : DEFAULT_GAMES;
+    seed = argc > 2 ? strtoul (argv[2], NULL, 10) : 1;
+    baronies = argc > 3 ? atoi (argv[3]) : BARONIES;
+    if (games <= 0 || baronies < 2 || baronies > MAX_BARONIES) {
+	fprintf (stderr, "Usage: %s [games] [seed] [baronies]\n",
+		 argv[0]);
+	return 1;
+    }
+
+    /* play and check the games */
+    seed_random (&rng, seed);
+    for (g = 0; g < games; ++g)
+	play_game (baronies, seed + g,
+		   g & 1 ? MATH_FLOAT : MATH_INTEGER);
+
+    /* report the checks */
+    printf ("games: %ld   baronies: %d\n", games, baronies);
+    printf ("check                    tested     failed\n");
+    status = 0;
+    for (c = 0; c < CHECKS; ++c) {
+	printf ("%-20s %10lu %10lu\n", check_names[c], tested[c],
+		failed[c]);
+	if (failed[c])
+	    status = 2;
+    }
+    return status;
+}
@@ -14,7 +14,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 /* project headers */
 #include "computer.h"
@@ -25,7 +24,7 @@
 #include "order.h"
 
 /*----------------------------------------------------------------------
- * Private Level 1 Functions.
+ * Private Level 2 Functions.
  */
 
 /**
@@ -38,19 +37,33 @@ static void computer_turn (game_t *game, int player)
     int target; /* target for attack */
     
     /* make a random attack */
-    target = rand () % BARONIES;
+    target = random_number (&game->rng, game->barony_count);
     if (target != player)
-	game->attacks[player][target] =
-	    new_attack (game->baronies[player],
-			game->baronies[target],
-			game->baronies[player]->knights / 2,
-			game->baronies[player]->footmen / 2);
+	new_attack (game, player, target,
+		    game->baronies[player].knights / 2,
+		    game->baronies[player].footmen / 2);
 
     /* make a purchase */
-    game->orders[player] = new_order (game->baronies[player]);
-    game->orders[player]->castles = game->baronies[player]->gold / 400;
-    game->orders[player]->knights = game->baronies[player]->gold / 40;
-    game->orders[player]->footmen = game->baronies[player]->gold / 8;
+    set_order (game, player,
+	       game->baronies[player].gold / 400,
+	       game->baronies[player].gold / 40,
+	       game->baronies[player].gold / 8);
+}
+
+/*----------------------------------------------------------------------
+ * Private Level 1 Functions.
+ */
+
+/**
+ * Play a turn for every computer-controlled barony.
+ * @param game is the game in play.
+ */
+static void computer_turns_all (game_t *game)
+{
+    int b; /* barony counter */
+    for (b = 0; b < game->barony_count; ++b)
+	if (game->baronies[b].control == CONTROL_COMPUTER)
+	    computer_turn (game, b);
 }
 
 /*----------------------------------------------------------------------
@@ -63,14 +76,5 @@ static void computer_turn (game_t *game, int player)
  */
 void computer_turns (game_t *game)
 {
-    int b; /* barony counter */
-
-    /* randomise seed at the start of the game */
-    if (game->turn == 1)
-	srand (time (0));
-    
-    /* loop through all the computer baronies */
-    for (b = 0; b < BARONIES; ++b)
-	if (game->baronies[b]->control == CONTROL_COMPUTER)
-	    computer_turn (game, b);
+    TIME_STAGE (game, STAGE_COMPUTER_TURNS, computer_turns_all (game));
 }
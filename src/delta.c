@@ -0,0 +1,237 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Delta Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "delta.h"
+#include "game.h"
+#include "barony.h"
+#include "order.h"
+#include "attack.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+/**
+ * Clear the marks left by the last turn recorded, and empty the
+ * record.
+ * @param delta is the delta.
+ */
+static void clear_record (delta_t *delta)
+{
+    int c; /* counter for changes and origins */
+    for (c = 0; c < delta->change_count; ++c)
+	delta->marks[delta->changed[c]] = 0;
+    for (c = 0; c < delta->origin_count; ++c)
+	delta->marks[delta->origins[4 * c]] = 0;
+    delta->change_count = delta->order_count = delta->attack_count
+	= delta->origin_count = 0;
+    delta->rank_low = delta->barony_count;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Create a delta to record the turns of a game.
+ * @param game is the game whose turns are to be recorded.
+ * @return the new delta.
+ */
+delta_t *new_delta (game_t *game)
+{
+    /* local variables */
+    delta_t *delta; /* the delta to return */
+    int baronies, /* number of baronies */
+	capacity; /* number of attacks */
+    char *memory; /* memory following the delta structure */
+
+    /* allocate the memory */
+    baronies = game->barony_count;
+    capacity = game->attack_capacity;
+    if (! (delta = malloc (sizeof (delta_t)
+			   + baronies * (sizeof (barony_t)
+					 + sizeof (order_t)
+					 + sizeof (rank_t))
+			   + capacity * sizeof (attack_t)
+			   + baronies * 7 * sizeof (int)
+			   + capacity * sizeof (int))))
+	fatal_error (FATAL_MEMORY);
+    delta->barony_count = baronies;
+    delta->attack_capacity = capacity;
+
+    /* carve out the tables */
+    memory = (char *) (delta + 1);
+    delta->baronies = (barony_t *) memory;
+    memory += baronies * sizeof (barony_t);
+    delta->orders = (order_t *) memory;
+    memory += baronies * sizeof (order_t);
+    delta->ranks = (rank_t *) memory;
+    memory += baronies * sizeof (rank_t);
+    delta->attacks = (attack_t *) memory;
+    memory += capacity * sizeof (attack_t);
+    delta->marks = (int *) memory;
+    memory += baronies * sizeof (int);
+    delta->changed = (int *) memory;
+    memory += baronies * sizeof (int);
+    delta->order_baronies = (int *) memory;
+    memory += baronies * sizeof (int);
+    delta->origins = (int *) memory;
+    memory += 4 * baronies * sizeof (int);
+    delta->attack_places = (int *) memory;
+
+    /* start with an empty record */
+    memset (delta->marks, 0, baronies * sizeof (int));
+    delta->change_count = delta->origin_count = 0;
+    clear_record (delta);
+    memcpy (&delta->scalars, game, offsetof (game_t, baronies));
+    return delta;
+}
+
+/**
+ * Process a single turn, recording what it changes.
+ * @param game is the game to process.
+ * @param delta is a delta made for the game, to record the turn.
+ */
+void process_turn_delta (game_t *game, delta_t *delta)
+{
+    /* check that the delta fits the game */
+    if (delta->barony_count != game->barony_count
+	|| delta->attack_capacity != game->attack_capacity)
+	fatal_error (FATAL_CONFIG);
+
+    /* record the scalars, and the rest as the turn changes it */
+    clear_record (delta);
+    memcpy (&delta->scalars, game, offsetof (game_t, baronies));
+    game->delta = delta;
+    process_turn (game);
+    game->delta = NULL;
+}
+
+/**
+ * Undo the turn recorded in a delta.
+ * The game is restored as it was before the turn. Its reports still
+ * describe the turn undone, until the next turn is processed.
+ * @param game is the game that processed the turn.
+ * @param delta is the delta that recorded it.
+ */
+void undo_turn (game_t *game, delta_t *delta)
+{
+    /* local variables */
+    int c, /* counter for changes and other entries */
+	*origin; /* shorthand pointer to an origin entry */
+
+    /* put back the baronies */
+    for (c = 0; c < delta->change_count; ++c)
+	game->baronies[delta->changed[c]]
+	    = delta->baronies[delta->changed[c]];
+
+    /* put back the rankings */
+    memcpy (&game->ranks[delta->rank_low], delta->ranks,
+	    (delta->barony_count - delta->rank_low) * sizeof (rank_t));
+
+    /* put back the orders and attacks that were spent */
+    for (c = 0; c < delta->order_count; ++c)
+	game->orders[delta->order_baronies[c]] = delta->orders[c];
+    for (c = 0; c < delta->attack_count; ++c)
+	game->attacks[delta->attack_places[c]] = delta->attacks[c];
+    for (c = 0, origin = delta->origins; c < delta->origin_count;
+	 ++c, origin += 4) {
+	game->first_attack[origin[0]] = origin[1];
+	game->committed_knights[origin[0]] = origin[2];
+	game->committed_footmen[origin[0]] = origin[3];
+    }
+
+    /* put back the turn, the attack pool counts and the like */
+    memcpy (game, &delta->scalars, offsetof (game_t, baronies));
+}
+
+/**
+ * Record a barony about to be changed by the turn being recorded.
+ * @param delta is the delta recording the turn.
+ * @param b is the barony.
+ * @param before is the barony as it is before the change.
+ */
+void record_barony (delta_t *delta, int b, barony_t *before)
+{
+    if (! (delta->marks[b] & MARK_BARONY)) {
+	delta->marks[b] |= MARK_BARONY;
+	delta->baronies[b] = *before;
+	delta->changed[delta->change_count++] = b;
+    }
+}
+
+/**
+ * Record an order about to be spent by the turn being recorded.
+ * @param delta is the delta recording the turn.
+ * @param b is the barony that placed the order.
+ * @param order is the order.
+ */
+void record_order (delta_t *delta, int b, order_t *order)
+{
+    delta->order_baronies[delta->order_count] = b;
+    delta->orders[delta->order_count++] = *order;
+}
+
+/**
+ * Record an attack about to be spent by the turn being recorded,
+ * and the attack chain and commitments of its origin.
+ * @param delta is the delta recording the turn.
+ * @param game is the game.
+ * @param a is the attack's place in the pool.
+ */
+void record_attack (delta_t *delta, game_t *game, int a)
+{
+    int o, /* the origin of the attack */
+	*origin; /* the origin's entry */
+    delta->attack_places[delta->attack_count] = a;
+    delta->attacks[delta->attack_count++] = game->attacks[a];
+    o = game->attacks[a].origin;
+    if (! (delta->marks[o] & MARK_ORIGIN)) {
+	delta->marks[o] |= MARK_ORIGIN;
+	origin = &delta->origins[4 * delta->origin_count++];
+	origin[0] = o;
+	origin[1] = game->first_attack[o];
+	origin[2] = game->committed_knights[o];
+	origin[3] = game->committed_footmen[o];
+    }
+}
+
+/**
+ * Record the rankings about to be changed by the turn being recorded.
+ * @param delta is the delta recording the turn.
+ * @param game is the game.
+ * @param low is the first place to be changed.
+ */
+void record_ranks (delta_t *delta, game_t *game, int low)
+{
+    delta->rank_low = low;
+    memcpy (delta->ranks, &game->ranks[low],
+	    (game->barony_count - low) * sizeof (rank_t));
+}
+
+/**
+ * Destroy a delta when it is no longer needed.
+ * @param delta is the delta to destroy.
+ */
+void end_delta (delta_t *delta)
+{
+    free (delta);
+}
@@ -31,7 +31,8 @@ static char *messages[FATAL_LAST] = {
     "cannot open file",
     "cannot open display",
     "config file anarchic.dat missing or invalid",
-    "this beta version is expired"
+    "this beta version is expired",
+    "game state hash is inconsistent"
 };
 
 /*----------------------------------------------------------------------
@@ -12,8 +12,10 @@
 
 /* standard C headers */
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /* project headers */
 #include "anarchic.h"
@@ -23,6 +25,11 @@
 #include "attack.h"
 #include "order.h"
 #include "report.h"
+#include "hash.h"
+#include "battle.h"
+#include "rules.h"
+#include "workers.h"
+#include "delta.h"
 
 /*----------------------------------------------------------------------
  * Data Definitions.
@@ -40,171 +47,180 @@ static char *names[] = {
     "Villiers"
 };
 
+/** @const WORK_LEAST is the fewest baronies given to a worker. */
+#define WORK_LEAST 256
+
+/**
+ * @struct front is a target of a barony's candidate attacks, as it
+ * stands when battle is joined whatever the candidate.
+ */
+struct front {
+
+    /** @var target is the target after payment and sending forces. */
+    barony_t target;
+
+    /** @var knights are the knights sent by other baronies. */
+    unsigned long int knights;
+
+    /** @var footmen are the footmen sent by other baronies. */
+    unsigned long int footmen;
+
+};
+
+/**
+ * @struct economy is the result of one barony's economic activity,
+ * worked out apart from the rest of the game and merged into the
+ * reports and the state hash afterwards.
+ */
+struct economy {
+
+    /** @var rehash is the change to the state hash. */
+    hash_t rehash;
+
+    /** @var migration is the change in population. */
+    int migration;
+
+    /** @var tax is the tax raised. */
+    int tax;
+
+    /** @var deserted is 1 if the military could not be paid. */
+    int deserted;
+
+    /** @var attrition is the desertion as the report gives it. */
+    unit_report_t attrition;
+
+    /** @var lost are the units lost to desertion. */
+    unit_report_t lost;
+
+    /** @var before is the barony beforehand, for any delta. */
+    barony_t before;
+
+};
+
+/** @def RULED is the version of a function for a game's rules. */
+#define RULED(game, name) \
+    ((game)->custom_rules ? name##_custom : name##_stock)
+
+/** @def GAME_RULES is a game's rules, or NULL for the stock rules. */
+#define GAME_RULES(game) \
+    ((game)->custom_rules ? &(game)->rules : NULL)
+
+/** @var stock is the stock ruleset. */
+static const ruleset_t stock = STOCK_RULES;
+
+/* the functions that depend on the rules, for the stock rules */
+#define RULES(name) name##_stock
+#define RULE(field) (stock.field)
+#include "ruled.h"
+
+/* the same functions, for a game's own rules */
+#define RULES(name) name##_custom
+#define RULE(field) (game->rules.field)
+#include "ruled.h"
+
 /*----------------------------------------------------------------------
- * Level 2 Private Functions.
+ * Level 3 Private Functions.
  */
 
 /**
- * Process inbound attacks on one barony.
+ * Get a barony's report, creating it if the report policy wants one.
  * @param game is the game to process.
- * @param t is the target barony.
+ * @param b is the barony.
+ * @return the report, or NULL if the barony gets no report.
  */
-static void inbound_attacks (game_t *game, int t)
+static report_t *barony_report (game_t *game, int b)
 {
-    /* local variables */
-    int o; /* origin barony counter */
-    unsigned long int
-	knights, /* total attacking knights */
-	footmen, /* total attacking footmen */
-	attack, /* total attacking force value */
-	defence, /* total defending force value */
-	land_taken, /* amount of land taken in the attack */
-	gold_looted, /* amount of gold looted in the attack */
-	castles_beaten, /* number of castles taken or razed */
-	castles_taken, /* number of castles taken */
-	castles_razed, /* number of castles razed */
-	knights_lost, /* knights lost by the attackers */
-	footmen_lost, /* footmen lost by the attackers */
-	footmen_slain; /* defending footmen slain */
-    float att_loss, /* proportion of attackers lost */
-	def_loss, /* proportion of defenders lost */
-	knights_part, /* proportion of knights sent by a barony */
-	footmen_part, /* proportion of footmen sent by a barony */
-	attack_part; /* proportion of a barony's part of the attack */
-
-    /* get totals of attacking forces and return if none */
-    knights = footmen = 0;
-    for (o = 0; o < BARONIES; ++o)
-	if (game->attacks[o][t]) {
-	    knights += game->attacks[o][t]->knights;
-	    footmen += game->attacks[o][t]->footmen;
-	}
-    attack = knights * 10 + footmen;
-    if (attack == 0)
-	return;
+    if (game->reports[b])
+	return game->reports[b];
+    if (game->report_policy == REPORT_NONE
+	|| (game->report_policy == REPORT_PLAYERS
+	    && game->baronies[b].control == CONTROL_COMPUTER))
+	return NULL;
+    return game->reports[b] = new_report
+	(&game->arena, &game->baronies[b]);
+}
 
-    /* calculate defence */
-    defence = game->baronies[t]->castles * 100
-	+ game->baronies[t]->footmen;
-
-    /* calculate losses on both sides */
-    att_loss = (float) defence / (attack + defence);
-    def_loss = (float) attack / (attack + defence);
-    land_taken = def_loss * game->baronies[t]->land;
-    gold_looted = def_loss * game->baronies[t]->gold;
-    castles_beaten = def_loss * game->baronies[t]->castles;
-    castles_taken = (knights / (float) (knights + footmen / 10))
-	* castles_beaten;
-    castles_razed = castles_beaten - castles_taken;
-    footmen_slain = def_loss * game->baronies[t]->footmen;
-    knights_lost = att_loss * knights;
-    footmen_lost = att_loss * footmen;
-
-    /* report on gains and losses to be applied */
-    for (o = 0; o < BARONIES; ++o)
-	if (game->attacks[o][t]) {
-	    
-	    /* work out how big a part of the attack was sent */
-	    knights_part = knights
-		? (float) game->attacks[o][t]->knights / knights
-		: 0;
-	    footmen_part = footmen
-		? (float) game->attacks[o][t]->footmen / footmen
-		: 0;
-	    attack_part = (float)
-		(game->attacks[o][t]->knights * 10
-		 + game->attacks[o][t]->footmen) / attack;
-
-	    /* create the attacker battle report */
-	    if (! game->reports[o])
-		game->reports[o] = new_report (game->baronies[o]);
-	    game->reports[o]->attacks[t]
-		= malloc (sizeof (attack_report_t));
-	    if (! game->reports[o]->attacks[t])
-		fatal_error (FATAL_MEMORY);
-
-	    /* create the defender battle report */
-	    if (! game->reports[t])
-		game->reports[t] = new_report (game->baronies[t]);
-	    game->reports[t]->defences[o]
-		= malloc (sizeof (attack_report_t));
-	    if (! game->reports[t]->defences[o])
-		fatal_error (FATAL_MEMORY);
-
-	    /* fill the attack and defence reports simultaneously */
-	    game->reports[o]->attacks[t]->origin
-		= game->reports[t]->defences[o]->origin
-		= game->baronies[o];
-	    game->reports[o]->attacks[t]->target
-		= game->reports[t]->defences[o]->target
-		= game->baronies[t];
-	    game->reports[o]->attacks[t]->knights_sent
-		= game->reports[t]->defences[o]->knights_sent
-		= game->attacks[o][t]->knights;
-	    game->reports[o]->attacks[t]->footmen_sent
-		= game->reports[t]->defences[o]->footmen_sent
-		= game->attacks[o][t]->footmen;
-	    game->reports[o]->attacks[t]->land_taken
-		= game->reports[t]->defences[o]->land_taken
-		= attack_part * land_taken;
-	    game->reports[o]->attacks[t]->gold_looted
-		= game->reports[t]->defences[o]->gold_looted
-		= footmen_part * gold_looted;
-	    game->reports[o]->attacks[t]->castles_taken
-		= game->reports[t]->defences[o]->castles_taken
-		= attack_part * castles_taken;
-	    game->reports[o]->attacks[t]->castles_razed
-		= game->reports[t]->defences[o]->castles_razed
-		= attack_part * castles_razed;
-	    game->reports[o]->attacks[t]->footmen_slain
-		= game->reports[t]->defences[o]->footmen_slain
-		= attack_part * footmen_slain;
-	    game->reports[o]->attacks[t]->knights_lost
-		= game->reports[t]->defences[o]->knights_lost
-		= knights_part * knights_lost;
-	    game->reports[o]->attacks[t]->footmen_lost
-		= game->reports[t]->defences[o]->footmen_lost
-		= footmen_part * footmen_lost;
-	}
+/**
+ * Revise the state hash for a change to one field of a barony.
+ * @param game is the game to process.
+ * @param b is the barony changed.
+ * @param field is the field changed.
+ * @param old is the old value of the field.
+ * @param new is the new value of the field.
+ */
+static void rehash_field (game_t *game, int b, barony_field_t field,
+			  int old, int new)
+{
+    if (old != new)
+	game->hash ^= barony_key (b, field, old)
+	    ^ barony_key (b, field, new);
 }
 
 /**
- * Apply the results of a battle to the baronies.
- * @param game is the game in play.
- * @param o is the id of the barony originating the attack.
- * @param t is the id of the target barony of the attack.
+ * Work out the change to the state hash made by changes to a barony.
+ * @param game is the game to process.
+ * @param b is the barony changed.
+ * @param before is a copy of the barony before the changes.
+ * @return the keys to add to and remove from the hash.
  */
-static void apply_battle_results (game_t *game, int o, int t)
+static hash_t barony_rehash (game_t *game, int b, barony_t *before)
 {
-    attack_report_t *report; /* shorthand pointer to attack report */
-    barony_t *origin, /* barony originating the attack */
-	*target; /* target of the attack */
-    attack_t *attack; /* shorthand pointer to the attack */
+    int f, /* field counter */
+	old, /* the old value of a field */
+	new; /* the new value of a field */
+    hash_t rehash; /* the change to return */
+    rehash = 0;
+    for (f = 0; f < BARONY_FIELDS; ++f)
+	if ((old = *barony_field (before, f))
+	    != (new = *barony_field (&game->baronies[b], f)))
+	    rehash ^= barony_key (b, f, old) ^ barony_key (b, f, new);
+    return rehash;
+}
 
-    /* initialise shorthands */
-    report = game->reports[o]->attacks[t];
-    origin = game->baronies[o];
-    target = game->baronies[t];
-    attack = game->attacks[o][t];
+/**
+ * Revise the state hash for the changes made to a barony.
+ * @param game is the game to process.
+ * @param b is the barony changed.
+ * @param before is a copy of the barony before the changes.
+ */
+static void rehash_barony (game_t *game, int b, barony_t *before)
+{
+    game->hash ^= barony_rehash (game, b, before);
+}
+
+/**
+ * Work out the outcome of all the attacks on one barony.
+ * @param game is the game in play.
+ * @param battle holds the total knights and footmen attacking, and
+ * receives the outcome.
+ * @param target is the target, after sending out its own forces.
+ * @return 1 if battle was joined, 0 if there was no attacking force.
+ */
+static int fight_battle (game_t *game, battle_t *battle,
+			 barony_t *target)
+{
+    battle->castles = target->castles;
+    battle->defenders = target->footmen;
+    battle->land = target->land;
+    battle->gold = target->gold;
+    return predict_battle (battle, game->battle_math,
+			   GAME_RULES (game));
+}
 
-    /* transfer land, gold and castle gains */
-    origin->land += report->land_taken;
+/**
+ * Apply a target's losses from one attacker's share of a battle.
+ * @param target is the target of the attack.
+ * @param report is the attacker's share of the battle.
+ */
+static void take_losses (barony_t *target, attack_report_t *report)
+{
+    /* lose land, gold, castles and footmen */
     target->land -= report->land_taken;
-    origin->gold += report->gold_looted;
     target->gold -= report->gold_looted;
-    origin->castles += report->castles_taken;
     target->castles -= report->castles_taken;
-
-    /* reduce attack forces by what was lost */
-    attack->knights -= report->knights_lost;
-    attack->footmen -= report->footmen_lost;
-
-    /* apply troop losses to both baronies */
     target->castles -= report->castles_razed;
-    origin->knights += report->knights_sent - report->knights_lost;
-    origin->footmen += report->footmen_sent - report->footmen_lost;
     target->footmen -= report->footmen_slain;
-    
+
     /* ensure that losses do not result in negative values */
     if (target->land < 0)
 	target->land = 0;
@@ -214,30 +230,413 @@ static void apply_battle_results (game_t *game, int o, int t)
 	target->castles = 0;
     if (target->footmen < 0)
 	target->footmen = 0;
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Private Functions.
+ */
+
+/**
+ * Fight the battle at one barony, sharing the outcome out among the
+ * attackers. Nothing is written but the barony's outcome and the
+ * shares of the attacks on it, so many baronies can be done at once.
+ * @param game is the game to process.
+ * @param t is the target barony.
+ */
+static void fight_target (game_t *game, int t)
+{
+    /* local variables */
+    int a; /* attack counter */
+    attack_t *sent; /* shorthand pointer to one barony's attack */
+    attack_report_t *battle; /* battle record for one attack */
+    battle_t *outcome; /* outcome of all the attacks */
+
+    /* total the attacking forces and return if there is no battle */
+    outcome = &game->outcomes[t];
+    outcome->knights = outcome->footmen = 0;
+    for (a = game->first_inbound[t]; a != -1; a = sent->inbound) {
+	sent = &game->attacks[a];
+	outcome->knights += sent->knights;
+	outcome->footmen += sent->footmen;
+    }
+    if (! fight_battle (game, outcome, &game->baronies[t]))
+	return;
+
+    /* record each attacker's share of the gains and losses */
+    for (a = game->first_inbound[t]; a != -1; a = sent->inbound) {
+	sent = &game->attacks[a];
+	battle = game->battles[a] = &game->shares[a];
+	battle->next_attack = battle->next_defence = NULL;
+	battle->origin = &game->baronies[sent->origin];
+	battle->target = &game->baronies[t];
+	battle->knights_sent = sent->knights;
+	battle->footmen_sent = sent->footmen;
+	share_battle (battle, outcome, sent->knights, sent->footmen,
+		      game->battle_math, GAME_RULES (game));
+    }
+}
+
+/**
+ * Add the battle at one barony to the reports, and tell any observer.
+ * @param game is the game to process.
+ * @param t is the target barony, at which battle was joined.
+ */
+static void report_battles (game_t *game, int t)
+{
+    /* local variables */
+    int a; /* attack counter */
+    attack_t *sent; /* shorthand pointer to one barony's attack */
+    attack_report_t *battle; /* battle record for one attack */
+    report_t *report; /* report to add the battle to */
+
+    /* chain each battle record to the reports wanted */
+    for (a = game->first_inbound[t]; a != -1; a = sent->inbound) {
+	sent = &game->attacks[a];
+	battle = game->battles[a];
+	if ((report = barony_report (game, sent->origin))) {
+	    if (report->last_attack)
+		report->last_attack->next_attack = battle;
+	    else
+		report->attacks = battle;
+	    report->last_attack = battle;
+	}
+	if ((report = barony_report (game, t))) {
+	    if (report->last_defence)
+		report->last_defence->next_defence = battle;
+	    else
+		report->defences = battle;
+	    report->last_defence = battle;
+	}
+	if (game->observer && game->observer->battle)
+	    game->observer->battle (game->observer, game, sent->origin,
+				    t, battle, &game->outcomes[t]);
+    }
+}
+
+/**
+ * Fight the battles at a run of baronies.
+ * @param context is the game to process.
+ * @param first is the first barony.
+ * @param last is the barony after the last.
+ */
+static void battle_work (void *context, int first, int last)
+{
+    game_t *game; /* the game to process */
+    int t; /* target counter */
+    game = context;
+    for (t = first; t < last; ++t)
+	if (game->first_inbound[t] != -1)
+	    fight_target (game, t);
+}
+
+/**
+ * Work out the economic activity of a run of baronies.
+ * @param context is the game to process.
+ * @param first is the first barony.
+ * @param last is the barony after the last.
+ */
+static void economy_work (void *context, int first, int last)
+{
+    game_t *game; /* the game to process */
+    int b; /* barony counter */
+    barony_t before; /* the barony before its economic activity */
+    game = context;
+    for (b = first; b < last; ++b) {
+	before = game->baronies[b];
+	RULED (game, barony_economy) (game, &game->baronies[b],
+				      &game->economies[b]);
+	if (game->hashing)
+	    game->economies[b].rehash
+		= barony_rehash (game, b, &before);
+	if (game->delta)
+	    game->economies[b].before = before;
+    }
+}
 
-    /* ensure that gains do not push values outside permitted range */
-    if (origin->gold > 32000)
-	origin->gold = 32000;
-    if (origin->castles > 320)
-	origin->castles = 320;
+/**
+ * Do some work on each barony of a game, sharing it among any
+ * workers.
+ * @param game is the game to process.
+ * @param work is the work to do.
+ */
+static void share_work (game_t *game, work_t work)
+{
+    if (game->workers)
+	run_workers (game->workers, work, game, game->barony_count,
+		     WORK_LEAST);
+    else
+	work (game, 0, game->barony_count);
+}
+
+/**
+ * Compare two ranks for sorting, most land first.
+ * @param a points to the first rank.
+ * @param b points to the second rank.
+ * @return <0 if a ranks first, >0 if b ranks first.
+ */
+static int compare_ranks (const void *a, const void *b)
+{
+    const rank_t *first = a, /* the first rank */
+	*second = b; /* the second rank */
+    if (first->land != second->land)
+	return first->land > second->land ? -1 : 1;
+    return first->barony - second->barony;
+}
+
+/**
+ * Send out the forces for an attack, and chain it to its target.
+ * The attack is spent from now on, so it leaves the state hash.
+ * @param game is the game in play.
+ * @param a is the attack's place in the pool.
+ */
+static void send_attack (game_t *game, int a)
+{
+    attack_t *attack; /* shorthand pointer to the attack */
+    barony_t *origin; /* barony originating the attack */
+    attack = &game->attacks[a];
+    origin = &game->baronies[attack->origin];
+    if (game->delta) {
+	record_attack (game->delta, game, a);
+	record_barony (game->delta, attack->origin, origin);
+    }
+    if (game->hashing) {
+	rehash_field (game, attack->origin, FIELD_KNIGHTS,
+		      origin->knights,
+		      origin->knights - attack->knights);
+	rehash_field (game, attack->origin, FIELD_FOOTMEN,
+		      origin->footmen,
+		      origin->footmen - attack->footmen);
+	game->hash ^= attack_key (attack);
+    }
+    origin->knights -= attack->knights;
+    origin->footmen -= attack->footmen;
+    game->battles[a] = NULL;
+    attack->inbound = game->first_inbound[attack->target];
+    game->first_inbound[attack->target] = a;
+}
+
+/**
+ * Apply the results of a battle to the baronies.
+ * @param game is the game in play.
+ * @param a is the place in the pool of the attack that was fought.
+ */
+static void apply_battle_results (game_t *game, int a)
+{
+    attack_report_t *report; /* shorthand pointer to attack report */
+    attack_t *attack; /* shorthand pointer to the attack */
+    barony_t *origin, /* barony originating the attack */
+	*target, /* target of the attack */
+	origin_before, /* the origin before the battle */
+	target_before; /* the target before the battle */
+
+    /* initialise shorthands */
+    report = game->battles[a];
+    attack = &game->attacks[a];
+    origin = &game->baronies[attack->origin];
+    target = &game->baronies[attack->target];
+    origin_before = *origin;
+    target_before = *target;
+
+    /* transfer the gains and losses */
+    if (report->land_taken)
+	game->land_changed = 1;
+    RULED (game, take_gains) (game, origin, report);
+    take_losses (target, report);
+
+    /* reduce attack forces by what was lost */
+    attack->knights -= report->knights_lost;
+    attack->footmen -= report->footmen_lost;
+
+    /* revise any state hash kept, and record the changes */
+    if (game->hashing) {
+	rehash_barony (game, attack->origin, &origin_before);
+	rehash_barony (game, attack->target, &target_before);
+    }
+    if (game->delta) {
+	record_barony (game->delta, attack->origin, &origin_before);
+	record_barony (game->delta, attack->target, &target_before);
+    }
 }
 
 /*----------------------------------------------------------------------
  * Level 1 Private Functions.
  */
 
+/**
+ * Set out the targets of a barony's candidate attacks as they stand
+ * when battle is joined, and the attacks on the barony itself.
+ * @param game is the game in progress.
+ * @param b is the barony.
+ * @param candidates are the candidates.
+ * @param count is the number of candidates.
+ * @param slots receives each barony's place among the fronts, or -1.
+ * @param fronts receives the targets.
+ * @param inbound receives the attacks on the barony in origin order.
+ * @return the number of attacks on the barony.
+ */
+static int set_out_fronts (game_t *game, int b, candidate_t *candidates,
+			   int count, int *slots, front_t *fronts,
+			   attack_t *inbound)
+{
+    /* local variables */
+    int c, /* candidate counter */
+	a, /* attack counter */
+	o, /* origin counter */
+	t, /* target of an attack */
+	used, /* number of fronts used */
+	inbound_count; /* number of attacks on the barony */
+    unsigned long long int mask; /* dense attacks left to visit */
+    attack_t *attack; /* shorthand pointer to an attack */
+    front_t *front; /* shorthand pointer to a front */
+
+    /* give each target its front, paid for its order and sent out */
+    for (t = 0; t < game->barony_count; ++t)
+	slots[t] = -1;
+    used = 0;
+    for (c = 0; c < count; ++c)
+	for (a = 0; a < candidates[c].attack_count; ++a)
+	    if (slots[t = candidates[c].attacks[a].target] == -1) {
+		front = &fronts[slots[t] = used++];
+		front->target = game->baronies[t];
+		if (game->orders[t].placed)
+		    RULED (game, pay_order) (game, &front->target,
+					     &game->orders[t]);
+		front->target.knights -= game->committed_knights[t];
+		front->target.footmen -= game->committed_footmen[t];
+		front->knights = front->footmen = 0;
+	    }
+
+    /* add the other baronies' attacks, and note those on the barony */
+    inbound_count = 0;
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= mask - 1) {
+	    attack = &game->attacks[lowest_attack (mask)];
+	    if (attack->origin == b)
+		continue;
+	    else if (attack->target == b)
+		inbound[inbound_count++] = *attack;
+	    else if (slots[attack->target] != -1) {
+		front = &fronts[slots[attack->target]];
+		front->knights += attack->knights;
+		front->footmen += attack->footmen;
+	    }
+	}
+    else
+	for (o = 0; o < game->barony_count; ++o)
+	    for (a = o == b ? -1 : game->first_attack[o]; a != -1;
+		 a = attack->next) {
+		attack = &game->attacks[a];
+		if (attack->target == b)
+		    inbound[inbound_count++] = *attack;
+		else if (slots[attack->target] != -1) {
+		    front = &fronts[slots[attack->target]];
+		    front->knights += attack->knights;
+		    front->footmen += attack->footmen;
+		}
+	    }
+    return inbound_count;
+}
+
+/**
+ * Work out what one candidate would do for a barony.
+ * @param game is the game in progress.
+ * @param b is the barony.
+ * @param candidate is the candidate.
+ * @param slots are each barony's place among the fronts, or -1.
+ * @param fronts are the targets of the candidates' attacks.
+ * @param inbound are the attacks on the barony in origin order.
+ * @param inbound_count is the number of attacks on the barony.
+ * @param summary receives the barony's state after the turn.
+ */
+static void evaluate_candidate (game_t *game, int b,
+				candidate_t *candidate, int *slots,
+				front_t *fronts, attack_t *inbound,
+				int inbound_count, summary_t *summary)
+{
+    /* local variables */
+    int a, /* attack counter */
+	i, /* inbound attack counter */
+	paid, /* 1 if the order was paid for */
+	defended; /* 1 if the barony was attacked */
+    barony_t barony; /* the barony as the turn goes on */
+    attack_t *attack; /* shorthand pointer to an attack */
+    front_t *front; /* shorthand pointer to a front */
+    battle_t defence, /* the outcome of the attacks on the barony */
+	outcome; /* the outcome of the attacks on a target */
+    attack_report_t share; /* the barony's share of a battle */
+    economy_t economy; /* the results of the barony's economy */
+
+    /* pay for the order and send out the forces */
+    barony = game->baronies[b];
+    paid = candidate->order
+	&& RULED (game, pay_order) (game, &barony, candidate->order);
+    for (a = 0; a < candidate->attack_count; ++a) {
+	barony.knights -= candidate->attacks[a].knights;
+	barony.footmen -= candidate->attacks[a].footmen;
+    }
+
+    /* fight the battle at the barony itself */
+    defence.knights = defence.footmen = 0;
+    for (i = 0; i < inbound_count; ++i) {
+	defence.knights += inbound[i].knights;
+	defence.footmen += inbound[i].footmen;
+    }
+    defended = fight_battle (game, &defence, &barony);
+
+    /* apply the losses and gains in origin and target order */
+    for (i = 0; defended && i < inbound_count && inbound[i].origin < b;
+	 ++i) {
+	share_battle (&share, &defence, inbound[i].knights,
+		      inbound[i].footmen, game->battle_math,
+		      GAME_RULES (game));
+	take_losses (&barony, &share);
+    }
+    for (a = 0; a < candidate->attack_count; ++a) {
+	attack = &candidate->attacks[a];
+	front = &fronts[slots[attack->target]];
+	outcome.knights = front->knights + attack->knights;
+	outcome.footmen = front->footmen + attack->footmen;
+	if (fight_battle (game, &outcome, &front->target)) {
+	    share.knights_sent = attack->knights;
+	    share.footmen_sent = attack->footmen;
+	    share_battle (&share, &outcome, attack->knights,
+			  attack->footmen, game->battle_math,
+			  GAME_RULES (game));
+	    RULED (game, take_gains) (game, &barony, &share);
+	}
+    }
+    for (; defended && i < inbound_count; ++i) {
+	share_battle (&share, &defence, inbound[i].knights,
+		      inbound[i].footmen, game->battle_math,
+		      GAME_RULES (game));
+	take_losses (&barony, &share);
+    }
+
+    /* deliver the units and process the economy */
+    if (paid)
+	RULED (game, deliver_order) (game, &barony, candidate->order);
+    RULED (game, barony_economy) (game, &barony, &economy);
+
+    /* summarise the barony */
+    summary->land = barony.land;
+    summary->population = barony.population;
+    summary->gold = barony.gold;
+    summary->castles = barony.castles;
+    summary->knights = barony.knights;
+    summary->footmen = barony.footmen;
+}
+
 /**
  * Clear reports from a previous turn.
+ * Every report object lives in the game's arena, so they are all
+ * released at once.
  * @param game is the game to process.
  */
 static void clear_reports (game_t *game)
 {
-    int b; /* barony counter */
-    for (b = 0; b < BARONIES; ++b)
-	if (game->reports[b]) {
-	    destroy_report (game->reports[b]);
-	    game->reports[b] = NULL;
-	}
+    reset_arena (&game->arena);
+    memset (game->reports, 0,
+	    game->barony_count * sizeof (report_t *));
 }
 
 /**
@@ -248,20 +647,21 @@ static void take_payments (game_t *game)
 {
     /* local variables */
     int b; /* barony counter */
-    unsigned long int
-	popcost, /* cost of order in population */
-	goldcost; /* cost of order in gold */
+    barony_t before; /* the barony before payment */
 
     /* loop through all the baronies */
-    for (b = 0; b < BARONIES; ++b)
-	if (game->orders[b]) {
-	    popcost = order_popcost (game->orders[b]);
-	    goldcost = order_goldcost (game->orders[b]);
-	    if (popcost <= game->baronies[b]->population &&
-		goldcost <= game->baronies[b]->gold) {
-		game->baronies[b]->population -= popcost;
-		game->baronies[b]->gold -= goldcost;
-		game->orders[b]->paid = 1;
+    for (b = 0; b < game->barony_count; ++b)
+	if (game->orders[b].placed) {
+	    before = game->baronies[b];
+	    if (game->delta)
+		record_order (game->delta, b, &game->orders[b]);
+	    if (RULED (game, pay_order) (game, &game->baronies[b],
+					 &game->orders[b])) {
+		game->orders[b].paid = 1;
+		if (game->hashing)
+		    rehash_barony (game, b, &before);
+		if (game->delta)
+		    record_barony (game->delta, b, &before);
 	    }
 	}
 }
@@ -274,30 +674,54 @@ static void fight_battles (game_t *game)
 {
     /* local variables */
     int b, /* barony counter */
-	t; /* target barony counter */
-
-    /* send out all the forces */
-    for (b = 0; b < BARONIES; ++b)
-	for (t = 0; t < BARONIES; ++t)
-	    if (game->attacks[b][t]) {
-		game->baronies[b]->knights
-		    -= game->attacks[b][t]->knights;
-		game->baronies[b]->footmen
-		    -= game->attacks[b][t]->footmen;
-	    }
-
-    /* process attacks on each barony in turn */
-    for (b = 0; b < BARONIES; ++b)
-	inbound_attacks (game, b);
-
-    /* apply reported gains and losses */
-    for (b = 0; b < BARONIES; ++b)
-	for (t = 0; t < BARONIES; ++t)
-	    if (game->reports[b] && game->reports[b]->attacks[t]) {
-		apply_battle_results (game, b, t);
-		free (game->attacks[b][t]);
-		game->attacks[b][t] = NULL;
-	    }
+	a, /* attack counter */
+	*first_inbound; /* shorthand pointer to the inbound chains */
+    unsigned long long int mask; /* dense attacks left to process */
+    attack_t *attacks; /* shorthand pointer to the attack pool */
+
+    /*
+     * send out all the forces, chaining each target's attackers; the
+     * attacks are taken last first, so that each goes to the head of
+     * its target's chain and the chains end up in origin order
+     */
+    attacks = game->attacks;
+    first_inbound = game->first_inbound;
+    for (b = 0; b < game->barony_count; ++b)
+	first_inbound[b] = -1;
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= ~(1ULL << a)) {
+	    a = highest_attack (mask);
+	    send_attack (game, a);
+	}
+    else
+	for (b = game->barony_count - 1; b >= 0; --b)
+	    for (a = game->first_attack[b]; a != -1;
+		 a = attacks[a].next)
+		send_attack (game, a);
+
+    /* fight the battles at every barony, then report them in turn */
+    share_work (game, battle_work);
+    if (game->report_policy != REPORT_NONE || game->observer)
+	for (b = 0; b < game->barony_count; ++b)
+	    if (first_inbound[b] != -1 && game->outcomes[b].attack)
+		report_battles (game, b);
+
+    /* apply reported gains and losses in origin and target order */
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= mask - 1) {
+	    a = lowest_attack (mask);
+	    if (game->battles[a])
+		apply_battle_results (game, a);
+	}
+    else
+	for (b = 0; b < game->barony_count; ++b)
+	    for (a = game->first_attack[b]; a != -1;
+		 a = attacks[a].next)
+		if (game->battles[a])
+		    apply_battle_results (game, a);
+
+    /* all attacks are now spent */
+    clear_attacks (game);
 }
 
 /**
@@ -308,47 +732,47 @@ static void deliver_units (game_t *game)
 {
     /* local variables */
     int b; /* barony counter */
+    report_t *report; /* the barony's report if it gets one */
+    barony_t before; /* the barony before delivery */
 
     /* loop through the baronies */
-    for (b = 0; b < BARONIES; ++b)
-	if (game->orders[b]) {
+    for (b = 0; b < game->barony_count; ++b)
+	if (game->orders[b].placed) {
 
 	    /* if order is paid for, deliver the units */
-	    if (game->orders[b]->paid) {
+	    if (game->orders[b].paid) {
 
 		/* deliver the units */
-		game->baronies[b]->castles += game->orders[b]->castles;
-		game->baronies[b]->knights += game->orders[b]->knights;
-		game->baronies[b]->footmen += game->orders[b]->footmen;
-
-		/* ensure units do not break limits */
-		if (game->baronies[b]->castles > 320)
-		    game->baronies[b]->castles = 320;
-		if (game->baronies[b]->knights > 3200)
-		    game->baronies[b]->knights = 3200;
-		if (game->baronies[b]->footmen > 32000)
-		    game->baronies[b]->footmen = 32000;
+		before = game->baronies[b];
+		RULED (game, deliver_order) (game, &game->baronies[b],
+					     &game->orders[b]);
+		if (game->hashing)
+		    rehash_barony (game, b, &before);
+		if (game->delta)
+		    record_barony (game->delta, b, &before);
 
 		/* set the reports */
-		if (! game->reports[b])
-		    game->reports[b] = new_report (game->baronies[b]);
-		game->reports[b]->delivered = new_unit_report
-		    (game->orders[b]->castles, game->orders[b]->knights,
-		     game->orders[b]->footmen);
+		if ((report = barony_report (game, b)))
+		    report->delivered = new_unit_report
+			(&game->arena, game->orders[b].castles,
+			 game->orders[b].knights,
+			 game->orders[b].footmen);
 	    }
 
 	    /* if order is not paid, generate a report */
-	    else if (game->orders[b]) {
-		if (! game->reports[b])
-		    game->reports[b] = new_report (game->baronies[b]);
-		game->reports[b]->notdelivered = new_unit_report
-		    (game->orders[b]->castles, game->orders[b]->knights,
-		     game->orders[b]->footmen);
-	    }
-
-	    /* destroy the purchase order */
-	    free (game->orders[b]);
-	    game->orders[b] = NULL;
+	    else if ((report = barony_report (game, b)))
+		report->notdelivered = new_unit_report
+		    (&game->arena, game->orders[b].castles,
+		     game->orders[b].knights, game->orders[b].footmen);
+
+	    /* tell any observer, and the purchase order is now spent */
+	    if (game->observer && game->observer->delivery)
+		game->observer->delivery (game->observer, game, b,
+					  &game->orders[b],
+					  game->orders[b].paid);
+	    if (game->hashing)
+		game->hash ^= order_key (b, &game->orders[b]);
+	    game->orders[b].placed = 0;
 	}
 }
 
@@ -360,179 +784,500 @@ static void process_economy (game_t *game)
 {
     /* local variables */
     int b; /* barony counter */
-    unsigned long int expenses; /* cost of upkeep of units */
-    float desertion; /* fraction of military that deserts */
+    economy_t *economy; /* shorthand pointer to a barony's economy */
+    report_t *report; /* the barony's report if it gets one */
+    observer_t *observer; /* shorthand pointer to the observer */
+
+    /* work out every barony's economy */
+    share_work (game, economy_work);
+    if (game->report_policy == REPORT_NONE && ! game->observer
+	&& ! game->hashing && ! game->delta)
+	return;
 
-    /* loop through all the baronies */
-    for (b = 0; b < BARONIES; ++b) {
-
-	/* work out and apply population changes and taxes */
-	if (! game->reports[b])
-	    game->reports[b] = new_report (game->baronies[b]);
-	game->reports[b]->migration
-	    = (game->baronies[b]->land
-	       - game->baronies[b]->population) / 2;
-	game->reports[b]->tax =
-	    game->baronies[b]->population / POPULATION_PER_GOLD;
-	game->baronies[b]->population += game->reports[b]->migration;
-	game->baronies[b]->gold += game->reports[b]->tax;
-
-	/* work out expenses */
-	expenses = calculate_expenses (game->baronies[b]);
-
-	/* reduce expenses and military if not affordable */
-	if (expenses > game->baronies[b]->gold) {
-	    desertion = (1.0 - game->baronies[b]->gold / expenses) / 2;
-	    game->reports[b]->attrition = new_unit_report
-		(desertion * game->baronies[b]->castles,
-		 desertion * game->baronies[b]->knights,
-		 desertion * game->baronies[b]->footmen);
-	    game->baronies[b]->castles *= (1 - desertion);
-	    game->baronies[b]->knights *= (1 - desertion);
-	    game->baronies[b]->footmen *= (1 - desertion);
-	    expenses = game->baronies[b]->gold;
+    /* merge the results into the reports, hash and any delta */
+    observer = game->observer;
+    for (b = 0; b < game->barony_count; ++b) {
+	economy = &game->economies[b];
+	if ((report = barony_report (game, b))) {
+	    report->migration = economy->migration;
+	    report->tax = economy->tax;
+	    if (economy->deserted)
+		report->attrition = new_unit_report
+		    (&game->arena, economy->attrition.castles,
+		     economy->attrition.knights,
+		     economy->attrition.footmen);
 	}
-
-	/* apply the expenses */
-	game->baronies[b]->gold -= expenses;
-
-	/* check that gold remains within limits */
-	if (game->baronies[b]->gold > 32000)
-	    game->baronies[b]->gold = 32000;
+	if (observer && observer->migration)
+	    observer->migration (observer, game, b, economy->migration,
+				 economy->tax);
+	if (economy->deserted && observer && observer->desertion)
+	    observer->desertion (observer, game, b,
+				 economy->lost.castles,
+				 economy->lost.knights,
+				 economy->lost.footmen);
+	if (game->hashing)
+	    game->hash ^= economy->rehash;
+	if (game->delta)
+	    record_barony (game->delta, b, &economy->before);
     }
 }
 
 /**
- * Calculate the rankings of the baronies.
+ * Revise the rankings of the baronies.
+ * Only baronies whose land has changed since they were last ranked
+ * are taken out and sorted; they are then merged back in among the
+ * others, which are already in order.
  * @param game is the game to process.
  */
 static void calculate_rankings (game_t *game)
 {
     /* local variables */
-    int order[BARONIES], /* order of the baronies */
-	b, /* barony counter */
-	sorted, /* flag indicates when sorting is done */
-	o, /* temporary storage for barony order */
+    int count, /* number of baronies */
+	first, /* first place whose barony's land has changed */
+	kept, /* number of ranks kept in place */
+	moved, /* number of ranks taken out */
+	low, /* first place whose ranking may have changed */
+	p, /* place counter */
 	ranking; /* ranking counter */
+    rank_t *ranks, /* shorthand pointer to the ranks */
+	*reranks; /* shorthand pointer to the ranks taken out */
+    barony_t *baronies, /* shorthand pointer to the baronies */
+	*barony; /* shorthand pointer to a barony being ranked */
 
-    /* initialise the order arbitrarily */
-    for (b = 0; b < BARONIES; ++b)
-	order[b] = b;
-    
-    /* sort the baronies by land */
-    do {
-	sorted = 1;
-	for (b = 0; b < BARONIES - 1; ++b)
-	    if (game->baronies[order[b]]->land
-		< game->baronies[order[b + 1]]->land) {
-		sorted = 0;
-		o = order[b];
-		order[b] = order[b + 1];
-		order[b + 1] = o;
-	    }
-    } while (! sorted);
-
-    /* allocate ranking numbers */
-    ranking = game->baronies[order[0]]->ranking = 1;
-    game->baronies[order[b]]->ranking = ranking;
-    for (b = 1; b < BARONIES; ++b) {
-	if (game->baronies[order[b]]->land
-	    < game->baronies[order[b - 1]]->land)
-	    ranking = b + 1;
-	game->baronies[order[b]]->ranking = ranking;
+    /* nothing to do if no land has changed hands */
+    if (! game->land_changed)
+	return;
+    game->land_changed = 0;
+    count = game->barony_count;
+    ranks = game->ranks;
+    reranks = game->reranks;
+    baronies = game->baronies;
+
+    /* find the first barony whose land has changed */
+    for (first = 0;
+	 first < count
+	     && ranks[first].land == baronies[ranks[first].barony].land;
+	 ++first);
+    if (first == count)
+	return;
+
+    /* take out the baronies whose land has changed, and sort them */
+    moved = 0;
+    for (p = first; p < count; ++p)
+	if (ranks[p].land != baronies[ranks[p].barony].land) {
+	    reranks[moved].barony = ranks[p].barony;
+	    reranks[moved++].land = baronies[ranks[p].barony].land;
+	}
+    qsort (reranks, moved, sizeof (rank_t), compare_ranks);
+
+    /* find the first place disturbed, and record it onwards */
+    for (low = first;
+	 low && compare_ranks (&reranks[0], &ranks[low - 1]) < 0;
+	 --low);
+    if (game->delta)
+	record_ranks (game->delta, game, low);
+
+    /* close up the ranks kept, and merge the others in from below */
+    kept = first;
+    for (p = first; p < count; ++p)
+	if (ranks[p].land == baronies[ranks[p].barony].land)
+	    ranks[kept++] = ranks[p];
+    for (p = count - 1; moved; --p)
+	if (kept && compare_ranks (&reranks[moved - 1],
+				   &ranks[kept - 1]) < 0)
+	    ranks[p] = ranks[--kept];
+	else
+	    ranks[p] = reranks[--moved];
+
+    /* allocate ranking numbers from the first place disturbed */
+    ranking = low ? baronies[ranks[low - 1].barony].ranking : 1;
+    for (p = low; p < count; ++p) {
+	if (p && ranks[p].land < ranks[p - 1].land)
+	    ranking = p + 1;
+	barony = &baronies[ranks[p].barony];
+	if (barony->ranking == ranking)
+	    continue;
+	if (game->hashing)
+	    rehash_field (game, ranks[p].barony, FIELD_RANKING,
+			  barony->ranking, ranking);
+	if (game->delta)
+	    record_barony (game->delta, ranks[p].barony, barony);
+	barony->ranking = ranking;
     }
 }
 
+/**
+ * Work out the size of the state tables of a game.
+ * @param game is the game.
+ * @return the size in bytes.
+ */
+static size_t state_size (game_t *game)
+{
+    return game->barony_count * (sizeof (barony_t) + sizeof (order_t)
+				 + 3 * sizeof (int) + sizeof (rank_t))
+	+ game->attack_capacity * sizeof (attack_t);
+}
+
+/**
+ * Allocate a game and lay out its tables in the same block.
+ * Tables holding pointers come first, for alignment; the state
+ * tables follow in one run, and then the remaining working space.
+ * @param baronies is the number of baronies.
+ * @return the new game, with its tables and arena but no state.
+ */
+static game_t *allocate_game (int baronies)
+{
+    /* local variables */
+    game_t *game; /* the game to return */
+    int capacity; /* number of attacks the pool can hold */
+    unsigned long int size; /* size of the block in bytes */
+    char *memory; /* memory following the game structure */
+
+    /* work out the attack capacity */
+    if (baronies <= BARONIES)
+	capacity = BARONIES * BARONIES;
+    else if (baronies - 1 < ATTACKS_PER_BARONY)
+	capacity = baronies * (baronies - 1);
+    else
+	capacity = baronies * ATTACKS_PER_BARONY;
+
+    /* allocate the memory, which must be addressable as one block */
+    size = sizeof (game_t)
+	+ (unsigned long int) capacity
+	* (sizeof (attack_report_t) + sizeof (attack_report_t *)
+	   + sizeof (attack_t))
+	+ (unsigned long int) baronies
+	* (sizeof (battle_t) + sizeof (economy_t) + sizeof (front_t)
+	   + sizeof (report_t *) + sizeof (barony_t) + sizeof (order_t)
+	   + 5 * sizeof (int) + 2 * sizeof (rank_t)
+	   + sizeof (attack_t));
+    if ((size_t) size != size || ! (game = malloc ((size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    game->barony_count = baronies;
+    game->attack_capacity = capacity;
+
+    /* carve out the working tables that hold pointers or longs */
+    memory = (char *) (game + 1);
+    game->shares = (attack_report_t *) memory;
+    memory += capacity * sizeof (attack_report_t);
+    game->outcomes = (battle_t *) memory;
+    memory += baronies * sizeof (battle_t);
+    game->economies = (economy_t *) memory;
+    memory += baronies * sizeof (economy_t);
+    game->fronts = (front_t *) memory;
+    memory += baronies * sizeof (front_t);
+    game->battles = (attack_report_t **) memory;
+    memory += capacity * sizeof (attack_report_t *);
+    game->reports = (report_t **) memory;
+    memory += baronies * sizeof (report_t *);
+
+    /* carve out the state tables */
+    game->baronies = (barony_t *) memory;
+    memory += baronies * sizeof (barony_t);
+    game->orders = (order_t *) memory;
+    memory += baronies * sizeof (order_t);
+    game->attacks = (attack_t *) memory;
+    memory += capacity * sizeof (attack_t);
+    game->first_attack = (int *) memory;
+    memory += baronies * sizeof (int);
+    game->committed_knights = (int *) memory;
+    memory += baronies * sizeof (int);
+    game->committed_footmen = (int *) memory;
+    memory += baronies * sizeof (int);
+    game->ranks = (rank_t *) memory;
+    memory += baronies * sizeof (rank_t);
+
+    /* carve out the rest of the working space */
+    game->first_inbound = (int *) memory;
+    memory += baronies * sizeof (int);
+    game->reranks = (rank_t *) memory;
+    memory += baronies * sizeof (rank_t);
+    game->slots = (int *) memory;
+    memory += baronies * sizeof (int);
+    game->inbound = (attack_t *) memory;
+
+    /* set up the reports and their arena */
+    memset (game->reports, 0, baronies * sizeof (report_t *));
+    init_arena (&game->arena, report_arena_size (baronies));
+    game->observer = NULL;
+    game->workers = NULL;
+    game->delta = NULL;
+#ifdef GAME_STATS
+    clear_game_stats (&game->stats);
+#endif
+
+    /* return the game */
+    return game;
+}
+
 /*----------------------------------------------------------------------
  * Public Functions.
  */
 
 /**
  * Create and initialise a new game.
+ * @param baronies is the number of baronies, from 2 to MAX_BARONIES.
  * @return the new game.
  */
-game_t *new_game (void)
+game_t *new_game (int baronies)
 {
     /* local variables */
     game_t *game; /* the game to create and return */
-    int b, /* a counter for baronies */
-	o, /* a counter for origins of attacks */
-	t; /* a counter for targets of attacks */
-
-    /* attempt to allocate memory */
-    if (! (game = malloc (sizeof (game_t))))
-	fatal_error (FATAL_MEMORY);
+    int b; /* a counter for baronies */
+    char name[NAME_LENGTH + 1]; /* name of a numbered barony */
 
-    /* initialise the turn */
+    /* allocate the game, and initialise the turn and generator */
+    if (baronies < 2 || baronies > MAX_BARONIES)
+	fatal_error (FATAL_CONFIG);
+    game = allocate_game (baronies);
     game->turn = 0;
+    seed_game (game, (unsigned long int) time (0));
+
+    /* create the baronies, numbering any beyond the named ones */
+    for (b = 0; b < baronies; ++b)
+	if (b < BARONIES)
+	    init_barony (&game->baronies[b], names[b]);
+	else {
+	    sprintf (name, "Barony %hu", (unsigned short int) (b + 1));
+	    init_barony (&game->baronies[b], name);
+	}
 
-    /* create the baronies */
-    for (b = 0; b < BARONIES; ++b)
-	game->baronies[b] = new_barony (names[b]);
+    /* start the baronies level, in order of their numbers */
+    for (b = 0; b < baronies; ++b) {
+	game->ranks[b].barony = b;
+	game->ranks[b].land = game->baronies[b].land;
+    }
+    game->land_changed = 0;
 
     /* initialise the attacks */
-    for (o = 0; o < BARONIES; ++o)
-	for (t = 0; t < BARONIES; ++t)
-	    game->attacks[o][t] = NULL;
+    clear_attacks (game);
 
     /* initialise the build and recruit orders */
-    for (b = 0; b < BARONIES; ++b)
-	game->orders[b] = NULL;
+    for (b = 0; b < baronies; ++b)
+	game->orders[b].placed = 0;
+
+    /* initialise the report and arithmetic options */
+    game->report_policy = REPORT_ALL;
+    game->battle_math = MATH_INTEGER;
 
-    /* initialise the reports */
-    for (b = 0; b < BARONIES; ++b)
-	game->reports[b] = NULL;
+    /* play to the stock rules until given others */
+    stock_rules (&game->rules);
+    game->custom_rules = 0;
+
+    /* the state hash is not kept until asked for */
+    game->hashing = 0;
+    game->hash = 0;
 
     /* return the new game */
     return game;
 }
 
+/**
+ * Create a copy of a game.
+ * The copy has reports of its own, and starts with none.
+ * @param game is the game to copy.
+ * @return the new game.
+ */
+game_t *game_clone (game_t *game)
+{
+    game_t *copy; /* the copy to return */
+    copy = allocate_game (game->barony_count);
+    game_copy_into (copy, game);
+    return copy;
+}
+
+/**
+ * Copy one game over another without allocating any memory.
+ * The reports of the destination game are discarded. A destination
+ * with a different number of baronies is a fatal error.
+ * @param dest is a game with the same number of baronies.
+ * @param game is the game to copy.
+ */
+void game_copy_into (game_t *dest, game_t *game)
+{
+    /* check that the destination has room for the state */
+    if (dest->barony_count != game->barony_count
+	|| dest->attack_capacity != game->attack_capacity)
+	fatal_error (FATAL_CONFIG);
+
+    /* copy the state, and discard the destination's reports */
+    memcpy (dest, game, offsetof (game_t, baronies));
+    memcpy (dest->baronies, game->baronies, state_size (game));
+    clear_reports (dest);
+}
+
+/**
+ * Seed a game's random number generator.
+ * @param game is the game to seed.
+ * @param seed is the seed value.
+ */
+void seed_game (game_t *game, unsigned long int seed)
+{
+    game->seed = seed;
+    seed_random (&game->rng, seed);
+}
+
 /**
  * Process a single turn.
  * @param game is the game to process.
  */
 void process_turn (game_t *game)
 {
-    if (game->turn < 12) {
-	clear_reports (game);
-	take_payments (game);
-	fight_battles (game);
-	deliver_units (game);
-	process_economy (game);
-	calculate_rankings (game);
+    if (game->turn < TURNS) {
+	TIME_STAGE (game, STAGE_CLEAR_REPORTS, clear_reports (game));
+	TIME_STAGE (game, STAGE_TAKE_PAYMENTS, take_payments (game));
+	TIME_STAGE (game, STAGE_FIGHT_BATTLES, fight_battles (game));
+	TIME_STAGE (game, STAGE_DELIVER_UNITS, deliver_units (game));
+	TIME_STAGE (game, STAGE_PROCESS_ECONOMY,
+		    process_economy (game));
+	TIME_STAGE (game, STAGE_CALCULATE_RANKINGS,
+		    calculate_rankings (game));
+	if (game->hashing)
+	    game->hash ^= turn_key (game->turn)
+		^ turn_key (game->turn + 1);
 	++game->turn;
     }
 }
 
+/**
+ * Work out what each of a batch of candidates would do for a barony.
+ * Each candidate stands in for the order and attacks the barony has
+ * placed, and the payments, battles, deliveries and economy of the
+ * turn are worked out for it as process_turn would, without changing
+ * the game. What all candidates share is worked out once, and each
+ * candidate visits only the baronies it attacks.
+ * @param game is the game in progress.
+ * @param b is the barony.
+ * @param candidates are the candidates to try.
+ * @param count is the number of candidates.
+ * @param summaries receive the barony's state after the turn, one
+ * for each candidate; its ranking is not worked out.
+ */
+void evaluate_candidates (game_t *game, int b, candidate_t *candidates,
+			  int count, summary_t *summaries)
+{
+    /* local variables */
+    int c, /* candidate counter */
+	inbound_count; /* number of attacks on the barony */
+
+    /* work out what the candidates share, then try each in turn */
+    inbound_count = set_out_fronts (game, b, candidates, count,
+				    game->slots, game->fronts,
+				    game->inbound);
+    for (c = 0; c < count; ++c)
+	evaluate_candidate (game, b, &candidates[c], game->slots,
+			    game->fronts, game->inbound, inbound_count,
+			    &summaries[c]);
+}
+
 /**
  * Clean up after a game.
  * @param game is the game to clean up.
  */
 void end_game (game_t *game)
 {
-    /* local variables */
-    int b, /* barony counter */
-	o, /* a counter for origins of attacks */
-	t; /* a counter for targets of attacks */
-
-    /* free memory from the baronies */
-    for (b = 0; b < BARONIES; ++b)
-	if (game->baronies[b])
-	    free (game->baronies[b]);
-
-    /* free memory from the attacks */
-    for (o = 0; o < BARONIES; ++o)
-	for (t = 0; t < BARONIES; ++t)
-	    if (game->attacks[o][t])
-		free (game->attacks[o][t]);
-
-    /* free memory from the reports */
-    clear_reports (game);
-    
-    /* free memory from the game */
+    free_arena (&game->arena);
     free (game);
 }
 
+/**
+ * Start or stop keeping the state hash of a game.
+ * @param game is the game.
+ * @param hashing is 1 to keep the hash, 0 to stop.
+ */
+void keep_hash (game_t *game, int hashing)
+{
+    if (hashing && ! game->hashing)
+	game->hash = calculate_hash (game);
+    game->hashing = hashing;
+}
+
+/**
+ * Set or clear the observer told of the results of a game's turns.
+ * @param game is the game.
+ * @param observer is the observer, or NULL for none.
+ */
+void set_observer (game_t *game, observer_t *observer)
+{
+    game->observer = observer;
+}
+
+/**
+ * Set or clear the worker pool that shares out the work of a game's
+ * turns.
+ * @param game is the game.
+ * @param workers is the pool, or NULL to work in line.
+ */
+void set_workers (game_t *game, workers_t *workers)
+{
+    game->workers = workers;
+}
+
+/**
+ * Set the rules a game is played to.
+ * @param game is the game.
+ * @param rules are the rules.
+ * @return 1 if the rules were set, 0 if they are not valid.
+ */
+int set_rules (game_t *game, ruleset_t *rules)
+{
+    if (! valid_rules (rules))
+	return 0;
+    game->rules = *rules;
+    game->custom_rules = ! is_stock_rules (rules);
+    return 1;
+}
+
+/**
+ * Get the rules a game is played to.
+ * @param game is the game.
+ * @return the rules, which must not be changed.
+ */
+ruleset_t *get_rules (game_t *game)
+{
+    return &game->rules;
+}
+
+/**
+ * Get the state hash of a game.
+ * @param game is the game.
+ * @return the hash.
+ */
+hash_t game_hash (game_t *game)
+{
+    if (! game->hashing)
+	return calculate_hash (game);
+#ifdef DEBUG
+    if (game->hash != calculate_hash (game))
+	fatal_error (FATAL_HASH);
+#endif
+    return game->hash;
+}
+
+/**
+ * Get the statistics of the stages of a game's turns.
+ * @param game is the game.
+ * @return the statistics, or NULL if they are not compiled in.
+ */
+game_stats_t *get_game_stats (game_t *game)
+{
+#ifdef GAME_STATS
+    return &game->stats;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * Get the baronies in ranking order.
+ * Baronies with equal land are given in order of their numbers.
+ * @param game is the game in progress.
+ * @return an array of one rank per barony, best first.
+ */
+rank_t *get_rankings (game_t *game)
+{
+    return game->ranks;
+}
 
 /**
  * Work out the maximum number of castles affordable.
@@ -545,21 +1290,22 @@ int max_castles_to_buy (game_t *game, int b)
 	gold; /* gold available */
 
     /* initialise population and gold available */
-    population = game->baronies[b]->population;
-    gold = game->baronies[b]->gold;
+    population = game->baronies[b].population;
+    gold = game->baronies[b].gold;
 
     /* reduce resources according to what's allocated */
-    if (game->orders[b]) {
+    if (game->orders[b].placed) {
 	population = population
-	    - game->orders[b]->knights * KNIGHT_COST
-	    - game->orders[b]->footmen;
+	    - game->orders[b].knights * game->rules.knight_cost
+	    - game->orders[b].footmen;
 	gold = gold
-	    - game->orders[b]->knights * KNIGHT_COST
-	    - game->orders[b]->footmen;
+	    - game->orders[b].knights * game->rules.knight_cost
+	    - game->orders[b].footmen;
     }
 
     /* return calculated value */
-    return (gold < population ? gold : population) / CASTLE_COST;
+    return (gold < population ? gold : population)
+	/ game->rules.castle_cost;
 }
 
 /**
@@ -573,21 +1319,22 @@ int max_knights_to_buy (game_t *game, int b)
     int gold; /* gold available */
 
     /* initialise population and gold available */
-    population = game->baronies[b]->population;
-    gold = game->baronies[b]->gold;
+    population = game->baronies[b].population;
+    gold = game->baronies[b].gold;
 
     /* reduce resources according to what's allocated */
-    if (game->orders[b]) {
+    if (game->orders[b].placed) {
 	population = population
-	    - game->orders[b]->castles * CASTLE_COST
-	    - game->orders[b]->footmen;
+	    - game->orders[b].castles * game->rules.castle_cost
+	    - game->orders[b].footmen;
 	gold = gold
-	    - game->orders[b]->castles * CASTLE_COST
-	    - game->orders[b]->footmen;
+	    - game->orders[b].castles * game->rules.castle_cost
+	    - game->orders[b].footmen;
     }
 
     /* return calculated value */
-    return (gold < population ? gold : population) / KNIGHT_COST;
+    return (gold < population ? gold : population)
+	/ game->rules.knight_cost;
 }
 
 /**
@@ -601,17 +1348,17 @@ int max_footmen_to_buy (game_t *game, int b)
     int gold; /* gold available */
 
     /* initialise population and gold available */
-    population = game->baronies[b]->population;
-    gold = game->baronies[b]->gold;
+    population = game->baronies[b].population;
+    gold = game->baronies[b].gold;
 
     /* reduce resources according to what's allocated */
-    if (game->orders[b]) {
+    if (game->orders[b].placed) {
 	population = population
-	    - game->orders[b]->castles * CASTLE_COST
-	    - game->orders[b]->knights * KNIGHT_COST;
+	    - game->orders[b].castles * game->rules.castle_cost
+	    - game->orders[b].knights * game->rules.knight_cost;
 	gold = gold
-	    - game->orders[b]->castles * CASTLE_COST
-	    - game->orders[b]->knights * KNIGHT_COST;
+	    - game->orders[b].castles * game->rules.castle_cost
+	    - game->orders[b].knights * game->rules.knight_cost;
     }
 
     /* return calculated value */
@@ -626,12 +1373,11 @@ int max_footmen_to_buy (game_t *game, int b)
  */
 int max_knights_to_send (game_t *game, int o, int t)
 {
-    int knights, /* knights available */
-	b; /* barony counter */
-    knights = game->baronies[o]->knights;
-    for (b = 0; b < BARONIES; ++b)
-	if (game->attacks[o][b] && b != t)
-	    knights -= game->attacks[o][b]->knights;
+    int knights; /* knights available */
+    attack_t *attack; /* any attack already made on the target */
+    knights = game->baronies[o].knights - game->committed_knights[o];
+    if ((attack = get_attack (game, o, t)))
+	knights += attack->knights;
     return knights;
 }
 
@@ -643,23 +1389,20 @@ int max_knights_to_send (game_t *game, int o, int t)
  */
 int max_footmen_to_send (game_t *game, int o, int t)
 {
-    int footmen, /* footmen available */
-	b; /* barony counter */
-    footmen = game->baronies[o]->footmen;
-    for (b = 0; b < BARONIES; ++b)
-	if (game->attacks[o][b] && b != t)
-	    footmen -= game->attacks[o][b]->footmen;
+    int footmen; /* footmen available */
+    attack_t *attack; /* any attack already made on the target */
+    footmen = game->baronies[o].footmen - game->committed_footmen[o];
+    if ((attack = get_attack (game, o, t)))
+	footmen += attack->footmen;
     return footmen;
 }
 
 /**
  * Work out the expenses for a barony's military.
+ * @param game is the game in progress.
  * @param barony is the barony concerned.
  */
-unsigned long int calculate_expenses (barony_t *barony)
+unsigned long int calculate_expenses (game_t *game, barony_t *barony)
 {
-    return
-	barony->castles * CASTLES_TAX / CASTLES_PER_TAX
-	+ barony->knights * KNIGHTS_TAX / KNIGHTS_PER_TAX
-	+ barony->footmen * FOOTMEN_TAX / FOOTMEN_PER_TAX;
+    return RULED (game, barony_expenses) (game, barony);
 }
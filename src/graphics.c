@@ -30,6 +30,7 @@
 #include "report.h"
 #include "order.h"
 #include "attack.h"
+#include "random.h"
 
 /*----------------------------------------------------------------------
  * Data Definitions.
@@ -122,6 +123,9 @@ static char *rankings[] = {
     "1st", "2nd", "3rd", "4th", "5th", "6th", "7th", "8th"
 };
 
+/** @var rng generates the random layout of the barony screens. */
+static random_t rng;
+
 /** @var humans is the number of human players. */
 static int humans;
 
@@ -352,7 +356,7 @@ static void init_horizons (void)
 
     /* scramble the order of the horizons */
     for (b = 0; b < 9; ++b) {
-	o = rand () % 9;
+	o = random_number (&rng, 9);
 	s = horizons[b];
 	horizons[b] = horizons[o];
 	horizons[o] = s;
@@ -378,7 +382,7 @@ static void init_landscapes (void)
 
 	/* randomise the icon positions */
 	for (p = 0; p < 36; ++p) {
-	    o = rand () % 36;
+	    o = random_number (&rng, 36);
 	    s = positions[b][o];
 	    positions[b][o] = positions[b][p];
 	    positions[b][p] = s;
@@ -649,7 +653,7 @@ state_t display_open (int argc, char **argv)
     load_assets ();
 
     /* initialise the layout of the barony screens */
-    srand (time (0));
+    seed_random (&rng, (unsigned long int) time (0));
     init_horizons ();
     init_landscapes ();
 
@@ -682,7 +686,7 @@ state_t display_new_game (game_t *game)
     /* count the humans */
     humans = 0;
     for (b = 0; b < 8; ++b)
-	if (game->baronies[b]->control == CONTROL_HUMAN)
+	if (game->baronies[b].control == CONTROL_HUMAN)
 	    ++humans;
     
     /* build up the initial display */
@@ -707,11 +711,11 @@ state_t display_new_game (game_t *game)
 		     DRAW_PSET);
 	    bit_font (buffer, fonts[1]);
 	    bit_print (buffer, 68 + 48 * c, 72 + 64 * r,
-		       centre (game->baronies[b]->name, 10));
+		       centre (game->baronies[b].name, 10));
 	    bit_font (buffer, fonts[3]);
 	    bit_print (buffer, 72 + 48 * c, 112 + 64 * r,
 		       centre (control_names
-				[game->baronies[b]->control], 8));
+				[game->baronies[b].control], 8));
 	}
 
     /* display the prompt */
@@ -775,13 +779,13 @@ state_t display_new_game (game_t *game)
 	/* react to space key */
 	if (ch == 13) ch = ' ';
 	if (ch == ' ' && b != 8) {
-	    humans += game->baronies[b]->control;
-	    game->baronies[b]->control = ! game->baronies[b]->control;
-	    humans -= game->baronies[b]->control;
+	    humans += game->baronies[b].control;
+	    game->baronies[b].control = ! game->baronies[b].control;
+	    humans -= game->baronies[b].control;
 	    bit_font (buffer, fonts[3]);
 	    bit_print (buffer, 72 + 48 * (b & 3), 112 + 64 * (b / 4),
 		       centre (control_names
-			       [game->baronies[b]->control], 8));
+			       [game->baronies[b].control], 8));
 	    if (humans == 1)
 		player = viewed = b;
 	    redraw (72 + 48 * (b & 3), 112 + 64 * (b / 4), 32, 8);
@@ -891,10 +895,10 @@ state_t display_main_menu (game_t *game)
 	    b = c + 4 * r;
 	    bit_put (buffer, shields[b], 72 + 48 * c, 48 + 64 * r,
 		     DRAW_PSET);
-	    if (game->baronies[b]->control == CONTROL_HUMAN) {
+	    if (game->baronies[b].control == CONTROL_HUMAN) {
 		bit_font (buffer, fonts[1]);
 		bit_print (buffer, 68 + 48 * c, 40 + 64 * r,
-			   centre (game->baronies[b]->name, 10));
+			   centre (game->baronies[b].name, 10));
 	    }
 	}
 
@@ -960,7 +964,7 @@ state_t display_main_menu (game_t *game)
 	/* react to space key */
 	if (ch == 13) ch = ' ';
 	if (ch == ' ' && b != 8 &&
-	    game->baronies[b]->control == CONTROL_HUMAN) {
+	    game->baronies[b].control == CONTROL_HUMAN) {
 	    viewed = player = b;
 	    state = DISPLAY_OWN_BARONY;
 	} else if (ch == ' ' && b == 8) {
@@ -988,7 +992,7 @@ state_t display_own_barony (game_t *game)
     
     /* initialise the screen */
     clear_screen ();
-    show_barony (game->turn, game->baronies[viewed]);
+    show_barony (game->turn, &game->baronies[viewed]);
     scr_put (scr, buffer, 0, 0, DRAW_PSET);
 
     /* main menu loop */
@@ -1039,7 +1043,7 @@ state_t display_other_barony (game_t *game)
     
     /* initialise the screen */
     clear_screen ();
-    show_barony (game->turn, game->baronies[viewed]);
+    show_barony (game->turn, &game->baronies[viewed]);
     scr_put (scr, buffer, 0, 0, DRAW_PSET);
 
     /* main menu loop */
@@ -1077,11 +1081,17 @@ state_t display_other_barony (game_t *game)
 state_t display_order (game_t *game)
 {
     int option, /* option selected */
-	ch; /* character input */
+	ch, /* character input */
+	castles, /* castles to build */
+	knights, /* knights to train */
+	footmen; /* footmen to draft */
 
     /* initialise values */
-    if (! game->orders[player])
-	game->orders[player] = new_order (game->baronies[player]);
+    if (! get_order (game, player))
+	new_order (game, player);
+    castles = game->orders[player].castles;
+    knights = game->orders[player].knights;
+    footmen = game->orders[player].footmen;
     option = 0;
     
     /* initialise the screen */
@@ -1132,9 +1142,9 @@ state_t display_order (game_t *game)
     show_number (204, 120, max_footmen_to_buy (game, player));
 
     /* show numbers currently ordered */
-    show_number (236, 56, game->orders[player]->castles);
-    show_number (236, 88, game->orders[player]->knights);
-    show_number (236, 120, game->orders[player]->footmen);
+    show_number (236, 56, castles);
+    show_number (236, 88, knights);
+    show_number (236, 120, footmen);
 
     /* show "Done" option */
     bit_font (buffer, fonts[2]);
@@ -1163,24 +1173,25 @@ state_t display_order (game_t *game)
 	if (ch == -75 || ch == -77) {
 	    switch (option) {
 	    case 0:
-		game->orders[player]->castles = alter_by_steps
-		    (game->orders[player]->castles, -76 - ch,
+		castles = alter_by_steps
+		    (castles, -76 - ch,
 		     max_castles_to_buy (game, player));
-		show_number (236, 56, game->orders[player]->castles);
+		show_number (236, 56, castles);
 		break;
 	    case 1:
-		game->orders[player]->knights = alter_by_steps
-		    (game->orders[player]->knights, -76 - ch,
+		knights = alter_by_steps
+		    (knights, -76 - ch,
 		     max_knights_to_buy (game, player));
-		show_number (236, 88, game->orders[player]->knights);
+		show_number (236, 88, knights);
 		break;
 	    case 2:
-		game->orders[player]->footmen = alter_by_steps
-		    (game->orders[player]->footmen, -76 - ch,
+		footmen = alter_by_steps
+		    (footmen, -76 - ch,
 		     max_footmen_to_buy (game, player));
-		show_number (236, 120, game->orders[player]->footmen);
+		show_number (236, 120, footmen);
 		break;
 	    }
+	    set_order (game, player, castles, knights, footmen);
 	    redraw (236, 56 + 32 * option, 20, 8);
 
 	    /* update max limits */
@@ -1196,24 +1207,25 @@ state_t display_order (game_t *game)
 	if (ch >= '0' && ch <= '9') {
 	    switch (option) {
 	    case 0:
-		game->orders[player]->castles = alter_by_digit
-		    (game->orders[player]->castles, ch - '0',
+		castles = alter_by_digit
+		    (castles, ch - '0',
 		     max_castles_to_buy (game, player));
-		show_number (236, 56, game->orders[player]->castles);
+		show_number (236, 56, castles);
 		break;
 	    case 1:
-		game->orders[player]->knights = alter_by_digit
-		    (game->orders[player]->knights, ch - '0',
+		knights = alter_by_digit
+		    (knights, ch - '0',
 		     max_knights_to_buy (game, player));
-		show_number (236, 88, game->orders[player]->knights);
+		show_number (236, 88, knights);
 		break;
 	    case 2:
-		game->orders[player]->footmen = alter_by_digit
-		    (game->orders[player]->footmen, ch - '0',
+		footmen = alter_by_digit
+		    (footmen, ch - '0',
 		     max_footmen_to_buy (game, player));
-		show_number (236, 120, game->orders[player]->footmen);
+		show_number (236, 120, footmen);
 		break;
 	    }
+	    set_order (game, player, castles, knights, footmen);
 	    redraw (236, 56 + 32 * option, 20, 8);
 
 	    /* update maximum limits */
@@ -1229,18 +1241,19 @@ state_t display_order (game_t *game)
 	if (ch == 8) {
 	    switch (option) {
 	    case 0:
-		game->orders[player]->castles /= 10;
-		show_number (236, 56, game->orders[player]->castles);
+		castles /= 10;
+		show_number (236, 56, castles);
 		break;
 	    case 1:
-		game->orders[player]->knights /= 10;
-		show_number (236, 88, game->orders[player]->knights);
+		knights /= 10;
+		show_number (236, 88, knights);
 		break;
 	    case 2:
-		game->orders[player]->footmen /= 10;
-		show_number (236, 120, game->orders[player]->footmen);
+		footmen /= 10;
+		show_number (236, 120, footmen);
 		break;
 	    }
+	    set_order (game, player, castles, knights, footmen);
 	    redraw (236, 56 + 32 * option, 20, 8);
 
 	    /* update maximum limits */
@@ -1287,12 +1300,8 @@ state_t display_order (game_t *game)
     } while (ch != 'D' && ch != 'd');
 
     /* remove the order if no units were ordered */
-    if (game->orders[player]->castles +
-	game->orders[player]->knights +
-	game->orders[player]->footmen == 0) {
-	free (game->orders[player]);
-	game->orders[player] = NULL;
-    }
+    if (castles + knights + footmen == 0)
+	cancel_order (game, player);
 
     /* back to looking at one's own barony when finished */
     return DISPLAY_OWN_BARONY;
@@ -1309,13 +1318,13 @@ state_t display_attack (game_t *game)
 	footmen, /* footmen to send */
 	option, /* option selected */
 	ch; /* character input */
+    attack_t *attack; /* the current attack */
 
     /* get current attack numbers */
-    if (game->attacks[player][viewed]) {
-	knights = game->attacks[player][viewed]->knights;
-	footmen = game->attacks[player][viewed]->footmen;
-	free (game->attacks[player][viewed]);
-	game->attacks[player][viewed] = NULL;
+    if ((attack = get_attack (game, player, viewed))) {
+	knights = attack->knights;
+	footmen = attack->footmen;
+	cancel_attack (game, player, viewed);
     } else
 	knights = footmen = 0;
 
@@ -1327,9 +1336,9 @@ state_t display_attack (game_t *game)
     /* display the two baronies */
     bit_font (buffer, fonts[1]);
     bit_print (buffer, 68, 32,
-	       centre (game->baronies[player]->name, 10));
+	       centre (game->baronies[player].name, 10));
     bit_print (buffer, 212, 32, centre
-	       (game->baronies[viewed]->name, 10));
+	       (game->baronies[viewed].name, 10));
     bit_put (buffer, shields[player], 72, 40, DRAW_PSET);
     bit_put (buffer, shields[viewed], 216, 40, DRAW_PSET);
     bit_put (buffer, icons[4][0], 72, 72, DRAW_PSET);
@@ -1476,10 +1485,7 @@ state_t display_attack (game_t *game)
     
     /* launch attack if any forces are committed */
     if (knights + footmen > 0)
-        game->attacks[player][viewed] =
-	    new_attack (game->baronies[player],
-			game->baronies[viewed],
-			knights, footmen);
+        new_attack (game, player, viewed, knights, footmen);
 
     /* return to the barony view */
     return DISPLAY_OTHER_BARONY;
@@ -1493,8 +1499,8 @@ state_t display_attack (game_t *game)
 state_t display_report (game_t *game)
 {
     report_t *report; /* report shorthand */
-    int b, /* barony counter */
-	ch; /* character input */
+    attack_report_t *battle; /* an attack or defence report */
+    int ch; /* character input */
     unsigned long int expenses; /* calculated expenses */
 
     /* initialise the screen */
@@ -1516,89 +1522,89 @@ state_t display_report (game_t *game)
     }
 
     /* report on attacks sent out */
-    for (b = 0; b < BARONIES; ++b)
-	if (report->attacks[b]) {
+    for (battle = report->attacks; battle;
+	 battle = battle->next_attack) {
 
-	    /* display the icon and clear the text area */
-	    bit_put (buffer, icons[4][1], 40, 88, DRAW_PSET);
-	    bit_ink (buffer, 0);
-	    bit_box (buffer, 80, 80, 200, 48);
-	    bit_ink (buffer, 3);
+	/* display the icon and clear the text area */
+	bit_put (buffer, icons[4][1], 40, 88, DRAW_PSET);
+	bit_ink (buffer, 0);
+	bit_box (buffer, 80, 80, 200, 48);
+	bit_ink (buffer, 3);
 
-	    /* display the boilerplate text */
-	    bit_font (buffer, fonts[3]);
-	    bit_print (buffer, 80, 80, "You attacked the barony of ");
-	    bit_print (buffer, 80, 88,
-		       "with ..... knights and ..... footmen.");
-	    bit_print (buffer, 80, 96,
-		       "You took ..... land and looted ..... gold.");
-	    bit_print (buffer, 80, 104,
-		       "You took ..... castles and razed .....,");
-	    bit_print (buffer, 80, 112, "and slew ..... footmen.");
-	    bit_print (buffer, 80, 120,
-		       "You lost ..... knights and ..... footmen.");
-
-	    /* fill in the fields */
-	    bit_font (buffer, fonts[1]);
-	    bit_print (buffer, 188, 80,
-		       report->attacks[b]->target->name);
-	    show_number (100, 88, report->attacks[b]->knights_sent);
-	    show_number (172, 88, report->attacks[b]->footmen_sent);
-	    show_number (116, 96, report->attacks[b]->land_taken);
-	    show_number (204, 96, report->attacks[b]->gold_looted);
-	    show_number (116, 104, report->attacks[b]->castles_taken);
-	    show_number (212, 104, report->attacks[b]->castles_razed);
-	    show_number (116, 112, report->attacks[b]->footmen_slain);
-	    show_number (116, 120, report->attacks[b]->knights_lost);
-	    show_number (188, 120, report->attacks[b]->footmen_lost);
-
-	    /* show prompt and await keypress */
-	    if (report_key ())
-		return DISPLAY_QUIT;
-	}
+	/* display the boilerplate text */
+	bit_font (buffer, fonts[3]);
+	bit_print (buffer, 80, 80, "You attacked the barony of ");
+	bit_print (buffer, 80, 88,
+		   "with ..... knights and ..... footmen.");
+	bit_print (buffer, 80, 96,
+		   "You took ..... land and looted ..... gold.");
+	bit_print (buffer, 80, 104,
+		   "You took ..... castles and razed .....,");
+	bit_print (buffer, 80, 112, "and slew ..... footmen.");
+	bit_print (buffer, 80, 120,
+		   "You lost ..... knights and ..... footmen.");
+
+	/* fill in the fields */
+	bit_font (buffer, fonts[1]);
+	bit_print (buffer, 188, 80,
+		   battle->target->name);
+	show_number (100, 88, battle->knights_sent);
+	show_number (172, 88, battle->footmen_sent);
+	show_number (116, 96, battle->land_taken);
+	show_number (204, 96, battle->gold_looted);
+	show_number (116, 104, battle->castles_taken);
+	show_number (212, 104, battle->castles_razed);
+	show_number (116, 112, battle->footmen_slain);
+	show_number (116, 120, battle->knights_lost);
+	show_number (188, 120, battle->footmen_lost);
+
+	/* show prompt and await keypress */
+	if (report_key ())
+	    return DISPLAY_QUIT;
+    }
 
     /* report on defence against attacks sent against us */
-    for (b = 0; b < BARONIES; ++b)
-	if (report->defences[b]) {
+    for (battle = report->defences; battle;
+	 battle = battle->next_defence) {
 
-	    /* display the icon and clear the text area */
-	    bit_put (buffer, icons[3][1], 40, 88, DRAW_PSET);
-	    bit_ink (buffer, 0);
-	    bit_box (buffer, 80, 80, 200, 48);
-	    bit_ink (buffer, 3);
+	/* display the icon and clear the text area */
+	bit_put (buffer, icons[3][1], 40, 88, DRAW_PSET);
+	bit_ink (buffer, 0);
+	bit_box (buffer, 80, 80, 200, 48);
+	bit_ink (buffer, 3);
 
-	    /* display the boilerplate text */
-	    bit_font (buffer, fonts[3]);
-	    bit_print (buffer, 80, 80,
-		       "You were attacked by the barony of ");
-	    bit_print (buffer, 80, 88,
-		       "with ..... knights and ..... footmen.");
-	    bit_print (buffer, 80, 96,
-		       "They took ..... land and looted ..... gold.");
-	    bit_print (buffer, 80, 104,
-		       "They took ..... castles and razed .....,");
-	    bit_print (buffer, 80, 112, "and slew ..... footmen.");
-	    bit_print (buffer, 80, 120,
-		       "They lost ..... knights and ..... footmen.");
-
-	    /* fill in the fields */
-	    bit_font (buffer, fonts[1]);
-	    bit_print (buffer, 220, 80,
-		       report->defences[b]->origin->name);
-	    show_number (100, 88, report->defences[b]->knights_sent);
-	    show_number (172, 88, report->defences[b]->footmen_sent);
-	    show_number (120, 96, report->defences[b]->land_taken);
-	    show_number (208, 96, report->defences[b]->gold_looted);
-	    show_number (120, 104, report->defences[b]->castles_taken);
-	    show_number (216, 104, report->defences[b]->castles_razed);
-	    show_number (116, 112, report->defences[b]->footmen_slain);
-	    show_number (120, 120, report->defences[b]->knights_lost);
-	    show_number (192, 120, report->defences[b]->footmen_lost);
-
-	    /* show prompt and await keypress */
-	    if (report_key ())
-		return DISPLAY_QUIT;
-	}
+	/* display the boilerplate text */
+	bit_font (buffer, fonts[3]);
+	bit_print (buffer, 80, 80,
+		   "You were attacked by the barony of ");
+	bit_print (buffer, 80, 88,
+		   "with ..... knights and ..... footmen.");
+	bit_print (buffer, 80, 96,
+		   "They took ..... land and looted ..... gold.");
+	bit_print (buffer, 80, 104,
+		   "They took ..... castles and razed .....,");
+	bit_print (buffer, 80, 112, "and slew ..... footmen.");
+	bit_print (buffer, 80, 120,
+		   "They lost ..... knights and ..... footmen.");
+
+	/* fill in the fields */
+	bit_font (buffer, fonts[1]);
+	bit_print (buffer, 220, 80,
+		   battle->origin->name);
+	show_number (100, 88, battle->knights_sent);
+	show_number (172, 88, battle->footmen_sent);
+	show_number (120, 96, battle->land_taken);
+	show_number (208, 96, battle->gold_looted);
+	show_number (120, 104, battle->castles_taken);
+	show_number (216, 104, battle->castles_razed);
+	show_number (116, 112, battle->footmen_slain);
+	show_number (120, 120, battle->knights_lost);
+	show_number (192, 120, battle->footmen_lost);
+
+	/* show prompt and await keypress */
+	if (report_key ())
+	    return DISPLAY_QUIT;
+    }
 
     /* population migration and tax income */
     bit_ink (buffer, 0);
@@ -1705,7 +1711,7 @@ state_t display_report (game_t *game)
     }
 
     /* outgoings */
-    expenses = calculate_expenses (report->barony);
+    expenses = calculate_expenses (game, report->barony);
     bit_ink (buffer, 0);
     bit_box (buffer, 40, 80, 240, 48);
     bit_ink (buffer, 3);
@@ -1753,7 +1759,7 @@ state_t display_end_turn (game_t *game)
     /* if one human player, go straight to their barony afterwards */
     if (humans == 1)
 	for (b = 0; b < BARONIES; ++b)
-	    if (game->baronies[b]->control == CONTROL_HUMAN) {
+	    if (game->baronies[b].control == CONTROL_HUMAN) {
 		player = viewed = b;
 		return game->turn == 11 ?
 		    DISPLAY_END_GAME :
@@ -1774,16 +1780,12 @@ state_t display_end_turn (game_t *game)
 state_t display_end_game (game_t *game)
 {
     int b, /* barony counter */
-	r, /* ranking counter */
 	o, /* order counter */
-	ch, /* character input */
-	order[BARONIES]; /* order of baronies */
+	ch; /* character input */
+    rank_t *order; /* baronies in rank order */
 
-    /* sort the baronies into rank order */
-    for (o = 0, r = 1; r <= BARONIES; ++r)
-	for (b = 0; b < BARONIES; ++b)
-	    if (game->baronies[b]->ranking == r)
-		order[o++] = b;
+    /* get the baronies in rank order */
+    order = get_rankings (game);
 
     /* initialise the screen */
     clear_screen ();
@@ -1792,17 +1794,17 @@ state_t display_end_game (game_t *game)
 
     /* display the barony rankings */
     for (o = 0; o < BARONIES; ++o) {
-	b = order[o];
+	b = order[o].barony;
 
 	/* even-numbered rankings on the right */
 	if (o & 1) {
 	    bit_put (buffer, shields[b], 160, 32 + 16 * o, DRAW_PSET);
 	    bit_font (buffer, fonts[3]);
 	    bit_print (buffer, 200, 40 + 16 * o,
-		       rankings[game->baronies[b]->ranking - 1]);
+		       rankings[game->baronies[b].ranking - 1]);
 	    bit_font (buffer, fonts[1]);
 	    bit_print (buffer, 200, 48 + 16 * o,
-		       game->baronies[b]->name);
+		       game->baronies[b].name);
 	}
 
 	/* odd-numbered rankings on the left */
@@ -1810,18 +1812,18 @@ state_t display_end_game (game_t *game)
 	    bit_put (buffer, shields[b], 128, 32 + 16 * o, DRAW_PSET);
 	    bit_font (buffer, fonts[3]);
 	    bit_print (buffer, 108, 40 + 16 * o,
-		       rankings[game->baronies[b]->ranking - 1]);
+		       rankings[game->baronies[b].ranking - 1]);
 	    bit_font (buffer, fonts[1]);
 	    bit_print (buffer,
-		       120 - 4 * strlen (game->baronies[b]->name),
+		       120 - 4 * strlen (game->baronies[b].name),
 		       48 + 16 * o,
-		       game->baronies[b]->name);
+		       game->baronies[b].name);
 	}
     }
 
     /* set cursor to last barony viewed */
     for (o = 0; o < BARONIES - 1; ++o)
-	if (order[o] == viewed)
+	if (order[o].barony == viewed)
 	    break;
 
     /* main input loop */
@@ -1840,7 +1842,7 @@ state_t display_end_game (game_t *game)
 	/* process digit keys to view a barony */
 	if (ch >= '1' && ch <= '8') {
 	    for (o = 0; o < BARONIES; ++o) {
-		if (order[o] == ch - '1')
+		if (order[o].barony == ch - '1')
 		    break;
 	    }
 	    ch = ' ';
@@ -1859,7 +1861,7 @@ state_t display_end_game (game_t *game)
     } while (ch != ' ' && ch != 13);
 
     /* barony selected */
-    viewed = order[o];
+    viewed = order[o].barony;
     return DISPLAY_END_BARONY;
 }
 
@@ -1874,14 +1876,14 @@ state_t display_end_barony (game_t *game)
     
     /* initialise the screen */
     clear_screen ();
-    show_barony (game->turn, game->baronies[viewed]);
+    show_barony (game->turn, &game->baronies[viewed]);
     scr_put (scr, buffer, 0, 0, DRAW_PSET);
 
     /* wait for a key and return */
     do {
 
 	/* if looking at a human barony, offer a report */
-	if (game->baronies[viewed]->control == CONTROL_HUMAN) {
+	if (game->baronies[viewed].control == CONTROL_HUMAN) {
 	    ch = show_menu (2, end_barony_menu, "\x1b");
 	    if (ch == 27 && confirm_exit ())
 		return DISPLAY_QUIT;
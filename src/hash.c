@@ -0,0 +1,199 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * State Hash Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "hash.h"
+#include "game.h"
+#include "barony.h"
+#include "order.h"
+#include "attack.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @enum key_kind_t enumerates the kinds of state element. */
+typedef enum {
+    KEY_BARONY = 1,
+    KEY_ORDER,
+    KEY_ATTACK,
+    KEY_TURN
+} key_kind_t;
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+/**
+ * Scramble a number into a pseudo-random key.
+ * This is the finaliser of the SplitMix64 generator, which turns
+ * each distinct number into a distinct, well mixed key.
+ * @param z is the number to scramble.
+ * @return the key.
+ */
+static hash_t mix (hash_t z)
+{
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Pack a kind of element, a number and a value for scrambling.
+ * @param kind is the kind of element.
+ * @param number identifies the element within its kind.
+ * @param value is a 32-bit value.
+ * @return the packed number.
+ */
+static hash_t pack (key_kind_t kind, unsigned long int number,
+		    int value)
+{
+    return ((hash_t) kind << 60)
+	^ ((hash_t) number << 32)
+	^ (hash_t) ((unsigned long int) value & 0xffffffffUL);
+}
+
+/**
+ * Pack two 32-bit values for scrambling.
+ * @param high is the value for the upper half.
+ * @param low is the value for the lower half.
+ * @return the packed number.
+ */
+static hash_t pair (int high, int low)
+{
+    return ((hash_t) ((unsigned long int) high & 0xffffffffUL) << 32)
+	| (hash_t) ((unsigned long int) low & 0xffffffffUL);
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Get the key for a field of a barony having a value.
+ * @param b is the barony.
+ * @param field is the field.
+ * @param value is the value of the field.
+ * @return the key.
+ */
+hash_t barony_key (int b, barony_field_t field, int value)
+{
+    return mix (pack (KEY_BARONY,
+		      (unsigned long int) b * BARONY_FIELDS + field,
+		      value));
+}
+
+/**
+ * Get the key for a barony's order.
+ * @param b is the barony.
+ * @param order is the order placed.
+ * @return the key.
+ */
+hash_t order_key (int b, order_t *order)
+{
+    return mix (mix (pack (KEY_ORDER, b, order->castles))
+		^ pair (order->knights, order->footmen));
+}
+
+/**
+ * Get the key for an attack.
+ * @param attack is the attack.
+ * @return the key.
+ */
+hash_t attack_key (attack_t *attack)
+{
+    return mix (mix (pack (KEY_ATTACK, attack->origin, attack->target))
+		^ pair (attack->knights, attack->footmen));
+}
+
+/**
+ * Get the key for the turn number.
+ * @param turn is the turn number.
+ * @return the key.
+ */
+hash_t turn_key (int turn)
+{
+    return mix (pack (KEY_TURN, 0, turn));
+}
+
+/**
+ * Work out the state hash of a game from scratch.
+ * @param game is the game.
+ * @return the hash.
+ */
+hash_t calculate_hash (game_t *game)
+{
+    /* local variables */
+    hash_t hash; /* the hash to return */
+    int b, /* barony counter */
+	f, /* field counter */
+	a; /* attack counter */
+    unsigned long long int mask; /* dense attacks left to hash */
+
+    /* hash the turn and the baronies */
+    hash = turn_key (game->turn);
+    for (b = 0; b < game->barony_count; ++b)
+	for (f = 0; f < BARONY_FIELDS; ++f)
+	    hash ^= barony_key
+		(b, f, *barony_field (&game->baronies[b], f));
+
+    /* hash the orders placed */
+    for (b = 0; b < game->barony_count; ++b)
+	if (game->orders[b].placed)
+	    hash ^= order_key (b, &game->orders[b]);
+
+    /* hash the attacks made */
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= mask - 1) {
+	    a = lowest_attack (mask);
+	    hash ^= attack_key (&game->attacks[a]);
+	}
+    else
+	for (b = 0; b < game->barony_count; ++b)
+	    for (a = game->first_attack[b]; a != -1;
+		 a = game->attacks[a].next)
+		hash ^= attack_key (&game->attacks[a]);
+
+    /* return the hash */
+    return hash;
+}
+
+/**
+ * Fold the holdings of a game's baronies into a running checksum.
+ * Unlike the state hash it is stable across versions, so the tools
+ * report it to show that games replay exactly.
+ * @param checksum is the checksum so far, or 0 for a game on its own.
+ * @param game is the game.
+ * @return the updated checksum.
+ */
+unsigned long int checksum_game (unsigned long int checksum,
+				 game_t *game)
+{
+    int b; /* barony counter */
+    barony_t *barony; /* shorthand pointer to barony */
+    for (b = 0; b < game->barony_count; ++b) {
+	barony = &game->baronies[b];
+	checksum = (checksum * 31 + barony->land) & 0xffffffffUL;
+	checksum = (checksum * 31 + barony->population) & 0xffffffffUL;
+	checksum = (checksum * 31 + barony->gold) & 0xffffffffUL;
+	checksum = (checksum * 31 + barony->castles) & 0xffffffffUL;
+	checksum = (checksum * 31 + barony->knights) & 0xffffffffUL;
+	checksum = (checksum * 31 + barony->footmen) & 0xffffffffUL;
+    }
+    return checksum;
+}
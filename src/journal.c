@@ -0,0 +1,852 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Journal Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "journal.h"
+#include "save.h"
+#include "game.h"
+#include "order.h"
+#include "attack.h"
+#include "hash.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @def RECORD_START is the size of the start common to all records. */
+#define RECORD_START 12
+
+/*----------------------------------------------------------------------
+ * Level 2 Private Functions.
+ */
+
+/**
+ * Work out the largest turn record a game can need.
+ * @param game is the game.
+ * @return the size in bytes.
+ */
+static unsigned long int record_capacity (game_t *game)
+{
+    return JOURNAL_ATTACK_PLACE (game->barony_count,
+				 game->attack_capacity);
+}
+
+/**
+ * Put an attack into a turn record.
+ * @param record is the turn record.
+ * @param place is the place of the attack.
+ * @param attack is the attack.
+ */
+static void put_attack (unsigned char *record, unsigned long int place,
+			attack_t *attack)
+{
+    set_snapshot_value (record, place, attack->origin);
+    set_snapshot_value (record, place + 4, attack->target);
+    set_snapshot_value (record, place + 8, attack->knights);
+    set_snapshot_value (record, place + 12, attack->footmen);
+}
+
+/**
+ * Read the start of the next record in a journal file.
+ * @param input is the journal file.
+ * @param start receives the record's magic and size.
+ * @return 1 if the start was read, 0 at the end of the file, or -1
+ * if the file ends part way through.
+ */
+static int read_start (FILE *input, unsigned char *start)
+{
+    size_t count; /* number of bytes read */
+    count = fread (start, 1, RECORD_START, input);
+    if (count == RECORD_START)
+	return 1;
+    if (count == 0 && ! ferror (input))
+	return 0;
+    return -1;
+}
+
+/**
+ * Skip the rest of a record in a journal file.
+ * @param input is the journal file, just after the record's start.
+ * @param start is the record's start.
+ * @return 1 if the record was skipped, 0 if not.
+ */
+static int skip_record (FILE *input, unsigned char *start)
+{
+    long int size; /* size of the record */
+    size = snapshot_value (start, JOURNAL_SIZE);
+    return size >= RECORD_START
+	&& ! fseek (input, size - RECORD_START, SEEK_CUR);
+}
+
+/**
+ * Add a keyframe to an index.
+ * @param index is the index.
+ * @param game is the number of the game.
+ * @param turn is the turn the game had reached.
+ * @param place is the place of the snapshot in the file.
+ */
+static void add_keyframe (journal_index_t *index, long int game,
+			  int turn, long int place)
+{
+    keyframe_t *keyframes; /* the enlarged keyframe table */
+    if (index->count == index->capacity) {
+	if (! (keyframes = realloc (index->keyframes,
+				    2 * index->capacity
+				    * sizeof (keyframe_t))))
+	    fatal_error (FATAL_MEMORY);
+	index->keyframes = keyframes;
+	index->capacity *= 2;
+    }
+    index->keyframes[index->count].game = game;
+    index->keyframes[index->count].turn = turn;
+    index->keyframes[index->count].place = place;
+    ++index->count;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+/**
+ * Make sure a journal has working space for a game's turn records.
+ * @param journal is the journal.
+ * @param game is the game.
+ */
+static void size_record (journal_t *journal, game_t *game)
+{
+    unsigned long int size; /* size of the working space needed */
+    unsigned char *record; /* the enlarged working space */
+    if ((size = record_capacity (game)) <= journal->capacity)
+	return;
+    if ((size_t) size != size
+	|| ! (record = realloc (journal->record, (size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    journal->record = record;
+    journal->capacity = size;
+}
+
+/**
+ * Allocate working space for a game's turn records.
+ * @param game is the game whose turns are read.
+ * @return the working space.
+ */
+static unsigned char *new_record (game_t *game)
+{
+    unsigned char *record; /* the working space to return */
+    unsigned long int size; /* its size in bytes */
+    size = record_capacity (game);
+    if ((size_t) size != size || ! (record = malloc ((size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    return record;
+}
+
+/**
+ * Write the orders and attacks given to a turn into a turn record.
+ * @param game is the game, before the turn is processed.
+ * @param record is the turn record.
+ * @return the size of the record in bytes.
+ */
+static unsigned long int write_inputs (game_t *game,
+				       unsigned char *record)
+{
+    /* local variables */
+    int b, /* barony counter */
+	a, /* attack counter */
+	orders, /* number of orders */
+	attacks; /* number of attacks */
+    unsigned long int place; /* place of an order */
+    unsigned long long int mask; /* dense attacks left to write */
+    order_t *order; /* shorthand pointer to an order */
+
+    /* write the orders placed */
+    orders = 0;
+    for (b = 0; b < game->barony_count; ++b)
+	if ((order = &game->orders[b])->placed) {
+	    place = JOURNAL_HEADER
+		+ (unsigned long int) orders++ * JOURNAL_ORDER;
+	    set_snapshot_value (record, place, b);
+	    set_snapshot_value (record, place + 4, order->castles);
+	    set_snapshot_value (record, place + 8, order->knights);
+	    set_snapshot_value (record, place + 12, order->footmen);
+	}
+
+    /* write the attacks in order of origin and target */
+    attacks = 0;
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= mask - 1) {
+	    a = lowest_attack (mask);
+	    put_attack (record,
+			JOURNAL_ATTACK_PLACE (orders, attacks++),
+			&game->attacks[a]);
+	}
+    else
+	for (b = 0; b < game->barony_count; ++b)
+	    for (a = game->first_attack[b]; a != -1;
+		 a = game->attacks[a].next)
+		put_attack (record,
+			    JOURNAL_ATTACK_PLACE (orders, attacks++),
+			    &game->attacks[a]);
+
+    /* write the counts and return the size */
+    set_snapshot_value (record, JOURNAL_ORDERS, orders);
+    set_snapshot_value (record, JOURNAL_ATTACKS, attacks);
+    return JOURNAL_ATTACK_PLACE (orders, attacks);
+}
+
+/**
+ * Append a keyframe of a game to a journal.
+ * @param journal is the journal.
+ * @param game is the game, the last started in the journal.
+ * @return 1 if the keyframe was written, 0 if not.
+ */
+static int write_keyframe (journal_t *journal, game_t *game)
+{
+    unsigned char header[KEYFRAME_HEADER]; /* the keyframe header */
+    long int place; /* place of the snapshot in the file */
+    memset (header, 0, KEYFRAME_HEADER);
+    memcpy (header, KEYFRAME_MAGIC, sizeof (KEYFRAME_MAGIC));
+    set_snapshot_value (header, JOURNAL_SIZE,
+			(long int) (KEYFRAME_HEADER
+				    + snapshot_size (game)));
+    if (fwrite (header, KEYFRAME_HEADER, 1, journal->output) != 1
+	|| (place = ftell (journal->output)) == -1
+	|| ! game_save (game, journal->output))
+	return 0;
+    add_keyframe (journal->index, journal->index->games - 1,
+		  game->turn, place);
+    return 1;
+}
+
+/**
+ * Read the next turn record of a game from a journal file.
+ * Keyframes are skipped. If the next thing in the file is not a turn
+ * record or a keyframe, the file is left where it was.
+ * @param input is the journal file.
+ * @param record is working space for turn records.
+ * @param capacity is the size of the working space.
+ * @return 1 if a record was read, 0 if there are no more for the
+ * game, or -1 if the record is not valid.
+ */
+static int read_record (FILE *input, unsigned char *record,
+			unsigned long int capacity)
+{
+    unsigned long int size; /* size of the record */
+    int status; /* status of the record start */
+
+    /* look for the next turn record, skipping keyframes */
+    while ((status = read_start (input, record)) == 1
+	   && ! memcmp (record, KEYFRAME_MAGIC,
+			sizeof (KEYFRAME_MAGIC)))
+	if (! skip_record (input, record))
+	    return -1;
+    if (status != 1)
+	return status;
+    if (memcmp (record, JOURNAL_MAGIC, sizeof (JOURNAL_MAGIC))) {
+	if (fseek (input, -(long int) RECORD_START, SEEK_CUR))
+	    return -1;
+	return 0;
+    }
+
+    /* read the rest of the record */
+    size = (unsigned long int) snapshot_value (record, JOURNAL_SIZE);
+    if (size < JOURNAL_HEADER || size > capacity
+	|| fread (record + RECORD_START, (size_t) size - RECORD_START,
+		  1, input) != 1
+	|| snapshot_value (record, JOURNAL_ORDERS) < 0
+	|| snapshot_value (record, JOURNAL_ATTACKS) < 0
+	|| size != JOURNAL_ATTACK_PLACE
+	(snapshot_value (record, JOURNAL_ORDERS),
+	 snapshot_value (record, JOURNAL_ATTACKS)))
+	return -1;
+    return 1;
+}
+
+/**
+ * Give the orders and attacks in a turn record to a game.
+ * @param game is the game.
+ * @param record is the turn record.
+ * @return 1 if the inputs were given, 0 if the record is not valid.
+ */
+static int read_inputs (game_t *game, unsigned char *record)
+{
+    /* local variables */
+    int f, /* generator state word counter */
+	o, /* order counter */
+	a, /* attack counter */
+	orders, /* number of orders */
+	attacks, /* number of attacks */
+	b, /* barony placing an order */
+	origin, /* origin of an attack */
+	target; /* target of an attack */
+    unsigned long int place; /* place of an order or attack */
+
+    /* check the turn and read the random number generator */
+    if (snapshot_value (record, JOURNAL_TURN) != game->turn)
+	return 0;
+    game->seed = (unsigned long int)
+	snapshot_value (record, JOURNAL_SEED) & 0xffffffffUL;
+    for (f = 0; f < 4; ++f)
+	game->rng.state[f] = (unsigned long int)
+	    snapshot_value (record, JOURNAL_RNG + 4 * f) & 0xffffffffUL;
+
+    /* place the orders */
+    orders = (int) snapshot_value (record, JOURNAL_ORDERS);
+    for (o = 0; o < orders; ++o) {
+	place = JOURNAL_HEADER + (unsigned long int) o * JOURNAL_ORDER;
+	b = (int) snapshot_value (record, place);
+	if (b < 0 || b >= game->barony_count)
+	    return 0;
+	set_order (game, b,
+		   (int) snapshot_value (record, place + 4),
+		   (int) snapshot_value (record, place + 8),
+		   (int) snapshot_value (record, place + 12));
+    }
+
+    /* make the attacks */
+    attacks = (int) snapshot_value (record, JOURNAL_ATTACKS);
+    for (a = 0; a < attacks; ++a) {
+	place = JOURNAL_ATTACK_PLACE (orders, a);
+	origin = (int) snapshot_value (record, place);
+	target = (int) snapshot_value (record, place + 4);
+	if (origin < 0 || origin >= game->barony_count
+	    || target < 0 || target >= game->barony_count
+	    || origin == target
+	    || ! new_attack (game, origin, target,
+			     (int) snapshot_value (record, place + 8),
+			     (int) snapshot_value (record, place + 12)))
+	    return 0;
+    }
+    return 1;
+}
+
+/**
+ * Replay turn records from a journal file.
+ * @param input is the journal file, just after a snapshot.
+ * @param game is the game loaded from the snapshot.
+ * @param record is working space for turn records.
+ * @param capacity is the size of the working space.
+ * @param turns is the number of turns to replay, or -1 for all.
+ * @param count receives the number of turns replayed.
+ * @return 1 if more turns follow, 0 if there are no more for the
+ * game, or -1 if a record is not valid or did not come out as
+ * recorded.
+ */
+static int replay_turns (FILE *input, game_t *game,
+			 unsigned char *record,
+			 unsigned long int capacity, int turns,
+			 long int *count)
+{
+    hash_t hash; /* state hash recorded for a turn */
+    int status; /* status of the last record read */
+    *count = 0;
+    status = 1;
+    while ((turns < 0 || *count < turns)
+	   && (status = read_record (input, record, capacity)) == 1) {
+	if (! read_inputs (game, record))
+	    return -1;
+	process_turn (game);
+	hash = (hash_t) ((unsigned long int)
+			 snapshot_value (record, JOURNAL_HASH)
+			 & 0xffffffffUL)
+	    | (hash_t) ((unsigned long int)
+			snapshot_value (record, JOURNAL_HASH + 4)
+			& 0xffffffffUL) << 32;
+	if (game_hash (game) != hash)
+	    return -1;
+	++*count;
+    }
+    return status;
+}
+
+/**
+ * Load a game from a snapshot in a journal file ready for replay.
+ * What was given to the game's next turn is cleared, as the turn
+ * record gives it again, and reports are turned off.
+ * @param input is the journal file, at the snapshot.
+ * @param policy receives the game's own report policy.
+ * @return the game, or NULL if the snapshot is not valid.
+ */
+static game_t *load_keyframe (FILE *input, report_policy_t *policy)
+{
+    game_t *game; /* the game to return */
+    int b; /* barony counter */
+    if (! (game = game_load (input)))
+	return NULL;
+    for (b = 0; b < game->barony_count; ++b)
+	cancel_order (game, b);
+    clear_attacks (game);
+    *policy = game->report_policy;
+    game->report_policy = REPORT_NONE;
+    return game;
+}
+
+/**
+ * Create an empty index.
+ * @return the new index.
+ */
+static journal_index_t *new_index (void)
+{
+    journal_index_t *index; /* the index to return */
+    if (! (index = malloc (sizeof (journal_index_t)))
+	|| ! (index->keyframes = malloc (16 * sizeof (keyframe_t))))
+	fatal_error (FATAL_MEMORY);
+    index->games = 0;
+    index->count = 0;
+    index->capacity = 16;
+    return index;
+}
+
+/**
+ * Read the index record at the end of a journal file.
+ * @param input is the journal file.
+ * @return the index, or NULL if the file does not end with one.
+ */
+static journal_index_t *read_index_record (FILE *input)
+{
+    /* local variables */
+    unsigned char trailer[INDEX_TRAILER], /* the index trailer */
+	*record; /* the whole index record */
+    unsigned long int size; /* size of the index record */
+    long int entries, /* number of entries */
+	e, /* entry counter */
+	place; /* place of an entry */
+    journal_index_t *index; /* the index to return */
+
+    /* find the index record from its trailer */
+    if (fseek (input, -(long int) INDEX_TRAILER, SEEK_END)
+	|| fread (trailer, INDEX_TRAILER, 1, input) != 1
+	|| memcmp (trailer + 4, INDEX_TAIL, sizeof (INDEX_TAIL)))
+	return NULL;
+    size = (unsigned long int) snapshot_value (trailer, 0);
+    if (size < INDEX_SIZE (0) || (size_t) size != size
+	|| (long int) size < 0
+	|| fseek (input, -(long int) size, SEEK_END))
+	return NULL;
+
+    /* read and check the record */
+    if (! (record = malloc ((size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    if (fread (record, (size_t) size, 1, input) != 1
+	|| memcmp (record, INDEX_MAGIC, sizeof (INDEX_MAGIC))
+	|| (unsigned long int) snapshot_value (record, JOURNAL_SIZE)
+	!= size
+	|| (entries = snapshot_value (record, INDEX_ENTRIES)) < 0
+	|| INDEX_SIZE (entries) != size) {
+	free (record);
+	return NULL;
+    }
+
+    /* make the index */
+    index = new_index ();
+    index->games = snapshot_value (record, INDEX_GAMES);
+    for (e = 0; e < entries; ++e) {
+	place = INDEX_HEADER + e * INDEX_ENTRY;
+	add_keyframe (index, snapshot_value (record, place),
+		      (int) snapshot_value (record, place + 4),
+		      (long int) ((unsigned long int)
+				  snapshot_value (record, place + 8)
+				  & 0xffffffffUL)
+		      | (long int) ((unsigned long int)
+				    snapshot_value (record, place + 12)
+				    << 16 << 16));
+    }
+    free (record);
+    return index;
+}
+
+/**
+ * Rebuild the index of a journal file by reading every record.
+ * @param input is the journal file.
+ * @return the index, or NULL if the file is not valid.
+ */
+static journal_index_t *scan_journal (FILE *input)
+{
+    /* local variables */
+    unsigned char start[RECORD_START], /* start of a record */
+	turn[4]; /* turn of a snapshot */
+    long int place, /* place of a record */
+	snapshot; /* place of a snapshot within it */
+    int status; /* status of a record start */
+    journal_index_t *index; /* the index to return */
+
+    /* read each record in turn */
+    index = new_index ();
+    if (fseek (input, 0, SEEK_SET))
+	status = -1;
+    else
+	while ((place = ftell (input)) != -1
+	       && (status = read_start (input, start)) == 1) {
+
+	    /* note each snapshot and keyframe */
+	    snapshot = -1;
+	    if (! memcmp (start, SNAPSHOT_MAGIC,
+			  sizeof (SNAPSHOT_MAGIC))) {
+		snapshot = place;
+		++index->games;
+	    } else if (! memcmp (start, KEYFRAME_MAGIC,
+				 sizeof (KEYFRAME_MAGIC))
+		       && index->games)
+		snapshot = place + KEYFRAME_HEADER;
+	    else if (memcmp (start, INDEX_MAGIC, sizeof (INDEX_MAGIC))
+		     && (memcmp (start, JOURNAL_MAGIC,
+				 sizeof (JOURNAL_MAGIC))
+			 || ! index->games)) {
+		status = -1;
+		break;
+	    }
+	    if (snapshot != -1) {
+		if (fseek (input, snapshot + SNAPSHOT_TURN, SEEK_SET)
+		    || fread (turn, 4, 1, input) != 1
+		    || fseek (input, place + RECORD_START, SEEK_SET)) {
+		    status = -1;
+		    break;
+		}
+		add_keyframe (index, index->games - 1,
+			      (int) snapshot_value (turn, 0), snapshot);
+	    }
+
+	    /* move on to the next record */
+	    if (! skip_record (input, start)) {
+		status = -1;
+		break;
+	    }
+	}
+
+    /* return the index if the whole file was read */
+    if (status == 0)
+	return index;
+    end_journal_index (index);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Open a journal file for writing.
+ * Games already in the file are kept, and new games are added after
+ * them; the file must be empty or a valid journal.
+ * @param output is the journal file, open for reading and appending.
+ * @param interval is the number of turns between keyframes, or 0 for
+ * none after each game's first snapshot.
+ * @return the new journal, or NULL if the file is not a journal.
+ */
+journal_t *new_journal (FILE *output, int interval)
+{
+    journal_t *journal; /* the journal to return */
+    journal_index_t *index; /* the index of the games in the file */
+
+    /* index the games already in the file */
+    if (fseek (output, 0, SEEK_END))
+	return NULL;
+    if (ftell (output) == 0)
+	index = new_index ();
+    else if (! (index = read_journal_index (output)))
+	return NULL;
+    if (fseek (output, 0, SEEK_END)) {
+	end_journal_index (index);
+	return NULL;
+    }
+
+    /* create the journal */
+    if (! (journal = malloc (sizeof (journal_t))))
+	fatal_error (FATAL_MEMORY);
+    journal->output = output;
+    journal->interval = interval;
+    journal->index = index;
+    journal->record = NULL;
+    journal->capacity = 0;
+    return journal;
+}
+
+/**
+ * Start recording a game in a journal.
+ * The game's snapshot is appended to the file straight away.
+ * @param journal is the journal.
+ * @param game is the game to record.
+ * @return 1 if the game was started, 0 if the file could not be
+ * written.
+ */
+int journal_game (journal_t *journal, game_t *game)
+{
+    long int place; /* place of the snapshot in the file */
+    size_record (journal, game);
+    if ((place = ftell (journal->output)) == -1
+	|| ! game_save (game, journal->output))
+	return 0;
+    add_keyframe (journal->index, journal->index->games++, game->turn,
+		  place);
+    return 1;
+}
+
+/**
+ * Process a single turn, appending it to a journal.
+ * @param game is the game to process, the last started in the journal.
+ * @param journal is the journal the game is recorded in.
+ * @return 1 if the turn was recorded, 0 if the file could not be
+ * written.
+ */
+int process_turn_journal (game_t *game, journal_t *journal)
+{
+    /* local variables */
+    unsigned char *record; /* shorthand pointer to the record */
+    unsigned long int size; /* size of the record */
+    hash_t hash; /* state hash after the turn */
+    int f; /* generator state word counter */
+
+    /* a finished game has no more turns to record */
+    if (game->turn >= TURNS)
+	return 1;
+
+    /* record what is given to the turn */
+    record = journal->record;
+    memset (record, 0, JOURNAL_HEADER);
+    memcpy (record, JOURNAL_MAGIC, sizeof (JOURNAL_MAGIC));
+    size = write_inputs (game, record);
+    set_snapshot_value (record, JOURNAL_SIZE, (long int) size);
+    set_snapshot_value (record, JOURNAL_TURN, game->turn);
+    set_snapshot_value (record, JOURNAL_SEED, (long int) game->seed);
+    for (f = 0; f < 4; ++f)
+	set_snapshot_value (record, JOURNAL_RNG + 4 * f,
+			    (long int) game->rng.state[f]);
+
+    /* process the turn and record what came of it */
+    process_turn (game);
+    hash = game_hash (game);
+    set_snapshot_value (record, JOURNAL_HASH,
+			(long int) (hash & 0xffffffffUL));
+    set_snapshot_value (record, JOURNAL_HASH + 4,
+			(long int) (hash >> 32 & 0xffffffffUL));
+    if (fwrite (record, (size_t) size, 1, journal->output) != 1)
+	return 0;
+
+    /* add a keyframe if one is due */
+    if (journal->interval && game->turn % journal->interval == 0)
+	return write_keyframe (journal, game);
+    return 1;
+}
+
+/**
+ * Close a journal, writing its index. The file is left open.
+ * @param journal is the journal to close.
+ * @return 1 if the index was written, 0 if not.
+ */
+int end_journal (journal_t *journal)
+{
+    /* local variables */
+    journal_index_t *index; /* shorthand pointer to the index */
+    unsigned char *record; /* the index record */
+    unsigned long int size, /* size of the index record */
+	place; /* place of an entry or the trailer */
+    long int e; /* entry counter */
+    int written; /* 1 if the index was written */
+
+    /* build the index record */
+    index = journal->index;
+    size = INDEX_SIZE (index->count);
+    if ((size_t) size != size || ! (record = malloc ((size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    memset (record, 0, INDEX_HEADER);
+    memcpy (record, INDEX_MAGIC, sizeof (INDEX_MAGIC));
+    set_snapshot_value (record, JOURNAL_SIZE, (long int) size);
+    set_snapshot_value (record, INDEX_GAMES, index->games);
+    set_snapshot_value (record, INDEX_ENTRIES, index->count);
+    for (e = 0; e < index->count; ++e) {
+	place = INDEX_HEADER + e * INDEX_ENTRY;
+	set_snapshot_value (record, place, index->keyframes[e].game);
+	set_snapshot_value (record, place + 4,
+			    index->keyframes[e].turn);
+	set_snapshot_value (record, place + 8,
+			    index->keyframes[e].place);
+	set_snapshot_value (record, place + 12,
+			    (long int) ((unsigned long int)
+					index->keyframes[e].place
+					>> 16 >> 16));
+    }
+    place = size - INDEX_TRAILER;
+    set_snapshot_value (record, place, (long int) size);
+    memcpy (record + place + 4, INDEX_TAIL, sizeof (INDEX_TAIL));
+
+    /* write it and clean up */
+    written = fwrite (record, (size_t) size, 1, journal->output) == 1;
+    free (record);
+    end_journal_index (index);
+    free (journal->record);
+    free (journal);
+    return written;
+}
+
+/**
+ * Move to the next game in a journal file, skipping any index.
+ * @param input is the journal file, between games.
+ * @return 1 if a game follows, 0 at the end of the file, or -1 if
+ * the file is not valid.
+ */
+int next_game (FILE *input)
+{
+    unsigned char start[RECORD_START]; /* start of a record */
+    int status; /* status of the record start */
+    while ((status = read_start (input, start)) == 1
+	   && ! memcmp (start, INDEX_MAGIC, sizeof (INDEX_MAGIC)))
+	if (! skip_record (input, start))
+	    return -1;
+    if (status != 1)
+	return status;
+    if (memcmp (start, SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC))
+	|| fseek (input, -(long int) RECORD_START, SEEK_CUR))
+	return -1;
+    return 1;
+}
+
+/**
+ * Rebuild the next game in a journal file without a display.
+ * Reports are not made while the turns are replayed. If fewer than
+ * all of the game's turns are replayed, the rest are skipped so that
+ * the file is left at the start of the next game.
+ * @param input is the journal file, at the start of a game.
+ * @param turns is the number of turns to replay, or -1 for all.
+ * @param replayed if not NULL receives the number of turns replayed.
+ * @return the game, or NULL if the journal is not valid or a turn
+ * did not come out as recorded.
+ */
+game_t *replay_journal (FILE *input, int turns, long int *replayed)
+{
+    /* local variables */
+    game_t *game; /* the game to return */
+    unsigned char *record; /* working space for turn records */
+    unsigned long int capacity; /* size of the working space */
+    report_policy_t policy; /* the game's own report policy */
+    long int count; /* number of turns replayed */
+    int status; /* status of the last record read */
+
+    /* load the game */
+    if (replayed)
+	*replayed = 0;
+    if (! (game = load_keyframe (input, &policy)))
+	return NULL;
+
+    /* replay the turns and skip any not to be replayed */
+    record = new_record (game);
+    capacity = record_capacity (game);
+    status = replay_turns (input, game, record, capacity, turns,
+			   &count);
+    while (status == 1)
+	status = read_record (input, record, capacity);
+
+    /* clean up and return the game */
+    free (record);
+    if (replayed)
+	*replayed = count;
+    if (status == -1) {
+	end_game (game);
+	return NULL;
+    }
+    game->report_policy = policy;
+    return game;
+}
+
+/**
+ * Read the index of a journal file.
+ * If the file has no index at its end, for instance because the
+ * writer did not close it, the index is rebuilt by reading the file.
+ * @param input is the journal file.
+ * @return the index, or NULL if the file is not valid.
+ */
+journal_index_t *read_journal_index (FILE *input)
+{
+    journal_index_t *index; /* the index to return */
+    if (! (index = read_index_record (input)))
+	index = scan_journal (input);
+    return index;
+}
+
+/**
+ * Rebuild a game in a journal file as it stood at a given turn.
+ * The game is loaded from the last snapshot before the turn, and the
+ * turns after the snapshot are replayed as by replay_journal.
+ * @param input is the journal file.
+ * @param index is the index of the file.
+ * @param game is the number of the game in the file, from 0.
+ * @param turn is the turn.
+ * @return the game, or NULL if the journal does not reach the turn,
+ * is not valid, or a turn did not come out as recorded.
+ */
+game_t *seek_journal (FILE *input, journal_index_t *index,
+		      long int game, int turn)
+{
+    /* local variables */
+    long int low, /* first keyframe that may be after the turn */
+	high, /* first keyframe known to be after the turn */
+	middle, /* keyframe to compare */
+	count; /* number of turns replayed */
+    keyframe_t *keyframe; /* the keyframe to start from */
+    game_t *found; /* the game to return */
+    unsigned char *record; /* working space for turn records */
+    report_policy_t policy; /* the game's own report policy */
+    int status; /* status of the turns replayed */
+
+    /* find the last keyframe at or before the turn */
+    low = 0;
+    high = index->count;
+    while (low < high) {
+	middle = low + (high - low) / 2;
+	keyframe = &index->keyframes[middle];
+	if (keyframe->game < game
+	    || (keyframe->game == game && keyframe->turn <= turn))
+	    low = middle + 1;
+	else
+	    high = middle;
+    }
+    if (low == 0
+	|| (keyframe = &index->keyframes[low - 1])->game != game)
+	return NULL;
+
+    /* load the keyframe and replay the turns after it */
+    if (fseek (input, keyframe->place, SEEK_SET)
+	|| ! (found = load_keyframe (input, &policy)))
+	return NULL;
+    if (found->turn == turn)
+	status = 1;
+    else {
+	record = new_record (found);
+	status = replay_turns (input, found, record,
+			       record_capacity (found),
+			       turn - found->turn, &count);
+	free (record);
+    }
+
+    /* return the game if it reached the turn */
+    if (status != 1 || found->turn != turn) {
+	end_game (found);
+	return NULL;
+    }
+    found->report_policy = policy;
+    return found;
+}
+
+/**
+ * Destroy a journal index when it is no longer needed.
+ * @param index is the index to destroy.
+ */
+void end_journal_index (journal_index_t *index)
+{
+    free (index->keyframes);
+    free (index);
+}
@@ -0,0 +1,174 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Lockstep Benchmark Module.
+ * Plays all-computer games a block at a time through the lockstep
+ * engine, and reports the time spent processing turns. Its checksums
+ * match anarchic-sim's for the same games.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "hash.h"
+#include "report.h"
+#include "lockstep.h"
+#include "fatal.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_GAMES is the number of games played by default. */
+#define DEFAULT_GAMES 10000
+
+/** @const DEFAULT_BLOCK is the number of games played at once. */
+#define DEFAULT_BLOCK 256
+
+/** @var maths are the names of the battle arithmetic options. */
+static char *maths[] = {
+    "integer",
+    "float"
+};
+
+/** @var math is the battle arithmetic for the games. */
+static battle_math_t math = MATH_INTEGER;
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Play a block of all-computer games from start to finish.
+ * @param games is room for the games.
+ * @param count is the number of games in the block.
+ * @param seed is the random number seed of the first game.
+ * @param checksum points to the running checksum of final states.
+ * @param ticks points to the running processor time spent in the
+ * engine.
+ * @return the number of turns processed.
+ */
+static long int play_block (game_t **games, int count,
+			    unsigned long int seed,
+			    unsigned long int *checksum,
+			    clock_t *ticks)
+{
+    int g, /* game counter */
+	playing; /* number of games still in play */
+    long int turns; /* number of turns processed */
+    clock_t start; /* processor time before each turn */
+
+    /* start the games */
+    for (g = 0; g < count; ++g) {
+	games[g] = new_game (BARONIES);
+	seed_game (games[g], seed + g);
+	games[g]->report_policy = REPORT_NONE;
+	games[g]->battle_math = math;
+    }
+
+    /* play every turn of every game, all games keeping in step */
+    for (turns = 0; ; turns += playing) {
+	for (playing = g = 0; g < count; ++g)
+	    if (games[g]->turn < TURNS) {
+		computer_turns (games[g]);
+		++playing;
+	    }
+	if (! playing)
+	    break;
+	start = clock ();
+	process_lockstep (games, count);
+	*ticks += clock () - start;
+    }
+
+    /* clean up and return */
+    for (g = 0; g < count; ++g) {
+	*checksum = checksum_game (*checksum, games[g]);
+	end_game (games[g]);
+    }
+    return turns;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The benchmark has no display, but the fatal error handler expects
+ * one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    game_t **games; /* the games of a block */
+    unsigned long int seed, /* seed for the first game */
+	checksum; /* checksum of the final game states */
+    long int count, /* number of games to play */
+	turns, /* total turns processed */
+	g; /* game counter */
+    int block; /* number of games played at once */
+    clock_t ticks; /* processor time spent in the engine */
+    double seconds; /* seconds spent in the engine */
+
+    /* get the parameters from the command line */
+    count = argc > 1 ? atol (argv[1]) : DEFAULT_GAMES;
+    seed = argc > 2 ? strtoul (argv[2], NULL, 10) : 1;
+    if (argc > 3)
+	for (math = MATH_INTEGER;
+	     math <= MATH_FLOAT && strcmp (argv[3], maths[math]);
+	     ++math);
+    block = argc > 4 ? atoi (argv[4]) : DEFAULT_BLOCK;
+    if (count <= 0 || math > MATH_FLOAT || block <= 0) {
+	fprintf (stderr, "Usage: %s [games] [seed] [integer|float]"
+		 " [block]\n", argv[0]);
+	return 1;
+    }
+
+    /* play all the games a block at a time */
+    if (! (games = malloc (block * sizeof (game_t *))))
+	fatal_error (FATAL_MEMORY);
+    turns = 0;
+    checksum = 0;
+    ticks = 0;
+    for (g = 0; g < count; g += block)
+	turns += play_block (games,
+			     count - g < block ? count - g : block,
+			     seed + g, &checksum, &ticks);
+    seconds = (double) ticks / CLOCKS_PER_SEC;
+    if (seconds <= 0)
+	seconds = 1.0 / CLOCKS_PER_SEC;
+    printf ("seconds    turns/second   checksum\n");
+    printf ("%7.3f %15.1f   %08lx\n", seconds, turns / seconds,
+	    checksum);
+
+    /* clean up */
+    free (games);
+    return 0;
+}
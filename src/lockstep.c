@@ -0,0 +1,36 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Lockstep Engine Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "lockstep.h"
+#include "game.h"
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Process a single turn of many games.
+ * @param games are the games, each with its orders and attacks.
+ * @param count is the number of games.
+ */
+void process_lockstep (game_t **games, int count)
+{
+    int g; /* game counter */
+    for (g = 0; g < count; ++g)
+	process_turn (games[g]);
+}
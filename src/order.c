@@ -18,57 +18,75 @@
 /* project headers */
 #include "order.h"
 #include "anarchic.h"
-#include "fatal.h"
+#include "game.h"
+#include "hash.h"
 
 /*----------------------------------------------------------------------
  * Public Functions.
  */
 
 /**
- * Create a new building and recruitment order.
- * @param barony is the barony placing the order.
+ * Place a new, empty building and recruitment order.
+ * Any order the barony has already placed is replaced.
+ * @param game is the game in progress.
+ * @param b is the barony placing the order.
  * @return the new order.
  */
-order_t *new_order (barony_t *barony)
+order_t *new_order (game_t *game, int b)
+{
+    return set_order (game, b, 0, 0, 0);
+}
+
+/**
+ * Place a building and recruitment order.
+ * Any order the barony has already placed is replaced.
+ * @param game is the game in progress.
+ * @param b is the barony placing the order.
+ * @param castles is the number of castles to build.
+ * @param knights is the number of knights to train.
+ * @param footmen is the number of footmen to draft.
+ * @return the order.
+ */
+order_t *set_order (game_t *game, int b, int castles, int knights,
+		    int footmen)
 {
     /* local variables */
     order_t *order; /* the new order */
 
-    /* attempt to reserve memory */
-    if (! (order = malloc (sizeof (order_t))))
-	fatal_error (FATAL_MEMORY);
-
     /* initialise the order */
-    order->barony = barony;
-    order->castles = 0;
-    order->knights = 0;
-    order->footmen = 0;
+    cancel_order (game, b);
+    order = &game->orders[b];
+    order->placed = 1;
+    order->castles = castles;
+    order->knights = knights;
+    order->footmen = footmen;
     order->paid = 0;
 
-    /* return the new order */
+    /* enter it in any state hash kept, and return it */
+    if (game->hashing)
+	game->hash ^= order_key (b, order);
     return order;
 }
 
 /**
- * Calculate the cost of an order in population.
- * @param order is the order to process.
- * @return the cost in population.
+ * Get a barony's order if it has placed one.
+ * @param game is the game in progress.
+ * @param b is the barony.
+ * @return a pointer to the order, or NULL if there is none.
  */
-int order_popcost (order_t *order)
+order_t *get_order (game_t *game, int b)
 {
-    return order->castles * CASTLE_COST
-	+ order->knights * KNIGHT_COST
-	+ order->footmen;
+    return game->orders[b].placed ? &game->orders[b] : NULL;
 }
 
 /**
- * Calculate the cost of an order in gold.
- * @param order is the order to process.
- * @return the cost in gold.
+ * Cancel a barony's order.
+ * @param game is the game in progress.
+ * @param b is the barony.
  */
-int order_goldcost (order_t *order)
+void cancel_order (game_t *game, int b)
 {
-    return order->castles * CASTLE_COST
-	+ order->knights * KNIGHT_COST
-	+ order->footmen;
+    if (game->orders[b].placed && game->hashing)
+	game->hash ^= order_key (b, &game->orders[b]);
+    game->orders[b].placed = 0;
 }
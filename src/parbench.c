@@ -0,0 +1,201 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Parallel Turn Benchmark Module.
+ * Plays one all-computer game with a great many baronies, first with
+ * its turns worked out in line and then with a pool of workers
+ * sharing them out, and checks that the game hash agrees after every
+ * turn. Each pass is timed by the clock at its best of ROUNDS, as the
+ * workers' processor time would be counted over again.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "report.h"
+#include "hash.h"
+#include "stats.h"
+#include "workers.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_BARONIES is the number of baronies by default. */
+#define DEFAULT_BARONIES 16384
+
+/** @const DEFAULT_THREADS is the number of workers by default. */
+#define DEFAULT_THREADS 4
+
+/** @const ROUNDS is the number of times each pass is timed. */
+#define ROUNDS 3
+
+/** @var policies are the names of the report policies. */
+static char *policies[] = {
+    "all",
+    "players",
+    "none"
+};
+
+/** @var policy is the report policy for the game. */
+static report_policy_t policy = REPORT_NONE;
+
+/** @var maths are the names of the battle arithmetic options. */
+static char *maths[] = {
+    "integer",
+    "float"
+};
+
+/** @var math is the battle arithmetic for the game. */
+static battle_math_t math = MATH_INTEGER;
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Play the game from start to finish.
+ * @param baronies is the number of baronies.
+ * @param seed is the random number seed for the game.
+ * @param workers is the worker pool, or NULL to play in line.
+ * @param hashes is filled with the game hash after each turn.
+ * @param checksum points to the checksum of the final state.
+ * @return the time spent processing turns, in nanoseconds.
+ */
+static stats_time_t play_game (int baronies, unsigned long int seed,
+			       workers_t *workers, hash_t *hashes,
+			       unsigned long int *checksum)
+{
+    game_t *game; /* the game to play */
+    stats_time_t start, /* time before each turn */
+	time; /* time spent processing turns */
+
+    /* start the game */
+    game = new_game (baronies);
+    seed_game (game, seed);
+    game->report_policy = policy;
+    game->battle_math = math;
+    keep_hash (game, 1);
+    set_workers (game, workers);
+
+    /* play every turn of the game */
+    for (time = 0; game->turn < TURNS; ) {
+	computer_turns (game);
+	start = stats_clock ();
+	process_turn (game);
+	time += stats_clock () - start;
+	hashes[game->turn - 1] = game_hash (game);
+    }
+
+    /* clean up and return */
+    *checksum = checksum_game (0, game);
+    end_game (game);
+    return time;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The benchmark has no display, but the fatal error handler expects
+ * one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    workers_t *workers; /* the worker pool */
+    unsigned long int seed, /* seed for the game */
+	checksums[2]; /* checksum of each pass */
+    hash_t hashes[2][TURNS]; /* game hash after each turn */
+    stats_time_t time, /* time spent in a pass */
+	best[2]; /* the best time of each pass */
+    int baronies, /* number of baronies */
+	threads, /* number of workers */
+	pass, /* 0 in line, 1 with workers */
+	round, /* round counter */
+	turn; /* turn counter */
+
+    /* get the parameters from the command line */
+    baronies = argc > 1 ? atoi (argv[1]) : DEFAULT_BARONIES;
+    threads = argc > 2 ? atoi (argv[2]) : DEFAULT_THREADS;
+    seed = argc > 3 ? strtoul (argv[3], NULL, 10) : 1;
+    if (argc > 4)
+	for (math = MATH_INTEGER;
+	     math <= MATH_FLOAT && strcmp (argv[4], maths[math]);
+	     ++math);
+    if (argc > 5)
+	for (policy = REPORT_ALL;
+	     policy <= REPORT_NONE
+		 && strcmp (argv[5], policies[policy]);
+	     ++policy);
+    if (baronies < 2 || baronies > MAX_BARONIES || threads < 1
+	|| math > MATH_FLOAT || policy > REPORT_NONE) {
+	fprintf (stderr, "Usage: %s [baronies] [threads] [seed]"
+		 " [integer|float] [all|players|none]\n", argv[0]);
+	return 1;
+    }
+    workers = new_workers (threads);
+    threads = worker_count (workers);
+
+    /* play the game each way in turn, keeping the best times */
+    for (round = 0; round < ROUNDS; ++round)
+	for (pass = 0; pass < 2; ++pass) {
+	    time = play_game (baronies, seed, pass ? workers : NULL,
+			      hashes[pass], &checksums[pass]);
+	    if (! round || time < best[pass])
+		best[pass] = time > 0 ? time : 1;
+	}
+    end_workers (workers);
+
+    /* report the passes */
+    printf ("baronies: %d   workers: %d   reports: %s"
+	    "   arithmetic: %s\n", baronies, threads,
+	    policies[policy], maths[math]);
+    printf ("pass      seconds   turns/second   checksum\n");
+    for (pass = 0; pass < 2; ++pass)
+	printf ("%-7s %9.3f %14.1f   %08lx\n",
+		pass ? "workers" : "inline", best[pass] / 1e9,
+		TURNS * 1e9 / best[pass], checksums[pass]);
+    printf ("speedup: %.2fx\n", (double) best[0] / best[1]);
+
+    /* check that the passes agree turn by turn */
+    for (turn = 0; turn < TURNS; ++turn)
+	if (hashes[0][turn] != hashes[1][turn]) {
+	    fprintf (stderr, "The passes disagree after turn %d\n",
+		     turn + 1);
+	    return 2;
+	}
+    if (checksums[0] != checksums[1]) {
+	fprintf (stderr, "The passes disagree at the end\n");
+	return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Random Number Generator Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "random.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const MASK32 keeps values to 32 bits where longs are wider. */
+#define MASK32 0xffffffffUL
+
+/*----------------------------------------------------------------------
+ * Private Functions.
+ */
+
+/**
+ * Rotate a 32-bit value left.
+ * @param value is the value to rotate.
+ * @param bits is the number of bits to rotate by.
+ * @return the rotated value.
+ */
+static unsigned long int rotate (unsigned long int value, int bits)
+{
+    return ((value << bits) | (value >> (32 - bits))) & MASK32;
+}
+
+/**
+ * Scramble a seed value to fill one word of generator state.
+ * @param seed points to the seed, which is advanced.
+ * @return the scrambled value.
+ */
+static unsigned long int scramble (unsigned long int *seed)
+{
+    unsigned long int z; /* the value being scrambled */
+    z = *seed = (*seed + 0x9e3779b9UL) & MASK32;
+    z = ((z ^ (z >> 16)) * 0x85ebca6bUL) & MASK32;
+    z = ((z ^ (z >> 13)) * 0xc2b2ae35UL) & MASK32;
+    return z ^ (z >> 16);
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Seed a random number generator.
+ * @param rng is the generator to seed.
+ * @param seed is the seed value.
+ */
+void seed_random (random_t *rng, unsigned long int seed)
+{
+    int s; /* state word counter */
+
+    /* fill the state, avoiding the all-zero state */
+    seed &= MASK32;
+    for (s = 0; s < 4; ++s)
+	rng->state[s] = scramble (&seed);
+    if (! (rng->state[0] | rng->state[1] | rng->state[2]
+	   | rng->state[3]))
+	rng->state[0] = 1;
+}
+
+/**
+ * Get the next raw 32-bit number from a generator.
+ * @param rng is the generator to use.
+ * @return a number from 0 to 0xffffffff.
+ */
+unsigned long int next_random (random_t *rng)
+{
+    unsigned long int result, /* the number to return */
+	t; /* shifted state word */
+
+    /* work out the result from the current state */
+    result = (rotate ((rng->state[1] * 5) & MASK32, 7) * 9) & MASK32;
+
+    /* advance the state */
+    t = (rng->state[1] << 9) & MASK32;
+    rng->state[2] ^= rng->state[0];
+    rng->state[3] ^= rng->state[1];
+    rng->state[1] ^= rng->state[2];
+    rng->state[0] ^= rng->state[3];
+    rng->state[2] ^= t;
+    rng->state[3] = rotate (rng->state[3], 11);
+
+    /* return the result */
+    return result;
+}
+
+/**
+ * Get a random number within a range.
+ * @param rng is the generator to use.
+ * @param range is the number of possible values.
+ * @return a number from 0 to range - 1.
+ */
+int random_number (random_t *rng, int range)
+{
+    return (int) (next_random (rng) % (unsigned long int) range);
+}
@@ -0,0 +1,184 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Journal Replay Module.
+ * Rebuilds every game in journal files without a display, checks
+ * each turn against its recorded hash and reports throughput. With
+ * -s, seeks to every turn of every game through the index instead.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "journal.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Replay every game in a journal file.
+ * @param filename is the name of the journal file.
+ * @param games points to the running count of games replayed.
+ * @param turns points to the running count of turns replayed.
+ * @return 1 if every game replayed, 0 if not.
+ */
+static int replay_file (char *filename, long int *games,
+			long int *turns)
+{
+    FILE *input; /* the journal file */
+    game_t *game; /* a game rebuilt from the journal */
+    long int replayed; /* turns replayed for a game */
+    int status; /* whether another game follows */
+
+    /* open the file */
+    if (! (input = fopen (filename, "rb"))) {
+	fprintf (stderr, "%s: cannot open\n", filename);
+	return 0;
+    }
+
+    /* replay the games until the end of the file */
+    while ((status = next_game (input)) == 1) {
+	game = replay_journal (input, -1, &replayed);
+	*turns += replayed;
+	if (! game) {
+	    fprintf (stderr, "%s: game %ld failed after %ld turns\n",
+		     filename, *games + 1, replayed);
+	    fclose (input);
+	    return 0;
+	}
+	++*games;
+	end_game (game);
+    }
+
+    /* close the file */
+    fclose (input);
+    if (status == -1)
+	fprintf (stderr, "%s: not a journal\n", filename);
+    return status == 0;
+}
+
+/**
+ * Seek to every turn of every game in a journal file.
+ * @param filename is the name of the journal file.
+ * @param games points to the running count of games sought.
+ * @param turns points to the running count of turns sought.
+ * @return 1 if every seek succeeded, 0 if not.
+ */
+static int seek_file (char *filename, long int *games, long int *turns)
+{
+    FILE *input; /* the journal file */
+    journal_index_t *index; /* the index of the file */
+    game_t *game; /* a game rebuilt from the journal */
+    long int g, /* game counter */
+	k; /* keyframe counter */
+    int turn; /* turn counter */
+
+    /* open the file and read its index */
+    if (! (input = fopen (filename, "rb"))) {
+	fprintf (stderr, "%s: cannot open\n", filename);
+	return 0;
+    }
+    if (! (index = read_journal_index (input))) {
+	fprintf (stderr, "%s: not a journal\n", filename);
+	fclose (input);
+	return 0;
+    }
+
+    /* seek to each turn from each game's first snapshot to its end */
+    k = 0;
+    for (g = 0; g < index->games; ++g) {
+	while (k < index->count && index->keyframes[k].game < g)
+	    ++k;
+	if (k == index->count || index->keyframes[k].game != g)
+	    continue;
+	for (turn = index->keyframes[k].turn;
+	     turn <= TURNS
+		 && (game = seek_journal (input, index, g, turn));
+	     ++turn) {
+	    ++*turns;
+	    end_game (game);
+	}
+	++*games;
+    }
+
+    /* clean up */
+    end_journal_index (index);
+    fclose (input);
+    return 1;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The replayer has no display, but the fatal error handler expects
+ * one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    long int games, /* number of games replayed */
+	turns; /* number of turns replayed */
+    int f, /* file counter */
+	seeking, /* 1 to seek through the index */
+	failed; /* number of files that failed */
+    clock_t start; /* processor time at the start */
+    double seconds; /* seconds elapsed */
+
+    /* check the command line */
+    seeking = argc > 1 && ! strcmp (argv[1], "-s");
+    if (argc < 2 + seeking) {
+	fprintf (stderr, "Usage: %s [-s] journal...\n", argv[0]);
+	return 1;
+    }
+
+    /* replay the journals */
+    games = turns = 0;
+    failed = 0;
+    start = clock ();
+    for (f = 1 + seeking; f < argc; ++f)
+	if (seeking)
+	    failed += ! seek_file (argv[f], &games, &turns);
+	else
+	    failed += ! replay_file (argv[f], &games, &turns);
+    seconds = (double) (clock () - start) / CLOCKS_PER_SEC;
+    if (seconds <= 0)
+	seconds = 1.0 / CLOCKS_PER_SEC;
+
+    /* report the throughput */
+    printf ("games: %ld   turns: %ld   seconds: %.3f\n",
+	    games, turns, seconds);
+    printf ("games/second: %.1f   turns/second: %.1f\n",
+	    games / seconds, turns / seconds);
+    printf ("failed: %d\n", failed);
+    return failed ? 2 : 0;
+}
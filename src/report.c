@@ -21,34 +21,53 @@
 #include "fatal.h"
 #include "barony.h"
 #include "attack.h"
+#include "arena.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const SLACK allows for the arena's alignment of each object. */
+#define SLACK (2 * sizeof (long int))
 
 /*----------------------------------------------------------------------
  * Public Functions.
  */
 
+/**
+ * Work out the arena size needed for the most reports in a turn.
+ * Each barony can have one report with three unit reports. Battle
+ * records are kept by the game alongside its attacks, so that
+ * battles can be fought at many baronies at once.
+ * @param baronies is the number of baronies in the game.
+ * @return the size in bytes.
+ */
+size_t report_arena_size (int baronies)
+{
+    return baronies * (sizeof (report_t) + SLACK)
+	+ 3 * baronies * (sizeof (unit_report_t) + SLACK);
+}
+
 /**
  * Create and initialise a new report.
+ * @param arena is the arena to allocate the report from.
  * @param barony is the barony the report is addressed to.
  * @return the new report.
  */
-report_t *new_report (barony_t *barony)
+report_t *new_report (arena_t *arena, barony_t *barony)
 {
     /* local variables */
     report_t *report; /* the report to return */
-    int b; /* barony counter */
 
     /* reservation of memory */
-    if (! (report = malloc (sizeof (report_t))))
-	fatal_error (FATAL_MEMORY);
+    report = arena_alloc (arena, sizeof (report_t));
 
     /* initialise barony */
     report->barony = barony;
 
     /* initialise the attack and defence reports */
-    for (b = 0; b < BARONIES; ++b) {
-	report->attacks[b] = NULL;
-	report->defences[b] = NULL;
-    }
+    report->attacks = report->last_attack = NULL;
+    report->defences = report->last_defence = NULL;
 
     /* initialise economic activity */
     report->migration = 0;
@@ -65,18 +84,19 @@ report_t *new_report (barony_t *barony)
 
 /**
  * Create a unit report and stuff it with values.
+ * @param arena is the arena to allocate the report from.
  * @param castles is the number of castles built.
  * @param knights is the number of knights trained.
  * @param footmen is the number of footmen drafted.
  */
-unit_report_t *new_unit_report (int castles, int knights, int footmen)
+unit_report_t *new_unit_report (arena_t *arena, int castles,
+				int knights, int footmen)
 {
     /* local variables */
     unit_report_t *report; /* report to return */
 
     /* allocate memory */
-    if (! (report = malloc (sizeof (unit_report_t))))
-	fatal_error (FATAL_MEMORY);
+    report = arena_alloc (arena, sizeof (unit_report_t));
 
     /* allocate the values */
     report->castles = castles;
@@ -86,32 +106,3 @@ unit_report_t *new_unit_report (int castles, int knights, int footmen)
     /* return the report */
     return report;
 }
-
-/**
- * Destroy a report when no longer needed.
- * @param report is the report to destroy.
- */
-void destroy_report (report_t *report)
-{
-    /* local variables */
-    int b; /* barony counter */
-
-    /* free memory from battle reports */
-    for (b = 0; b < BARONIES; ++b) {
-	if (report->attacks[b])
-	    free (report->attacks[b]);
-	if (report->defences[b])
-	    free (report->defences[b]);
-    }
-
-    /* free memory from unit reports */
-    if (report->delivered)
-	free (report->delivered);
-    if (report->notdelivered)
-	free (report->notdelivered);
-    if (report->attrition)
-	free (report->attrition);
-
-    /* free memory from reports in general */
-    free (report);
-}
@@ -0,0 +1,207 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Ruleset Benchmark Module.
+ * Plays all-computer games on the stock rules' own path and on the
+ * path for a game's own rules, given the stock rules, to show that
+ * the two agree and what the stock path saves; then plays them to
+ * any ruleset read from a file. The passes take turns, and each is
+ * timed at its best of ROUNDS. Checksums match anarchic-sim's for
+ * the same games.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "hash.h"
+#include "report.h"
+#include "rules.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_GAMES is the number of games played by default. */
+#define DEFAULT_GAMES 10000
+
+/** @const ROUNDS is the number of times each pass is timed. */
+#define ROUNDS 3
+
+/** @enum path_t is the way a pass plays its games. */
+typedef enum {
+    PATH_STOCK, /* the stock rules on their own path */
+    PATH_GENERIC, /* the stock rules on the path for any rules */
+    PATH_FILE /* the rules from the file */
+} path_t;
+
+/** @var paths are the names of the passes. */
+static char *paths[] = {
+    "stock",
+    "generic",
+    "file"
+};
+
+/** @var maths are the names of the battle arithmetic options. */
+static char *maths[] = {
+    "integer",
+    "float"
+};
+
+/** @var math is the battle arithmetic for the games. */
+static battle_math_t math = MATH_INTEGER;
+
+/** @var rules are the rules read from a file. */
+static ruleset_t rules;
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Play a single all-computer game from start to finish.
+ * @param path is the way to play it.
+ * @param seed is the random number seed for the game.
+ * @param checksum points to the running checksum of final states.
+ * @param ticks points to the running processor time spent
+ * processing turns.
+ * @return the number of turns processed.
+ */
+static long int play_game (path_t path, unsigned long int seed,
+			   unsigned long int *checksum, clock_t *ticks)
+{
+    game_t *game; /* the game to play */
+    long int turns; /* number of turns processed */
+    clock_t start; /* processor time before each turn */
+
+    /* start the game on the path wanted */
+    game = new_game (BARONIES);
+    seed_game (game, seed);
+    game->report_policy = REPORT_NONE;
+    game->battle_math = math;
+    if (path == PATH_GENERIC)
+	game->custom_rules = 1;
+    else if (path == PATH_FILE)
+	set_rules (game, &rules);
+
+    /* play every turn of the game */
+    for (turns = 0; game->turn < TURNS; ++turns) {
+	computer_turns (game);
+	start = clock ();
+	process_turn (game);
+	*ticks += clock () - start;
+    }
+
+    /* clean up and return */
+    *checksum = checksum_game (*checksum, game);
+    end_game (game);
+    return turns;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The benchmark has no display, but the fatal error handler expects
+ * one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    FILE *input; /* the ruleset file */
+    unsigned long int seed, /* seed for the first game */
+	checksums[PATH_FILE + 1]; /* checksums of each pass */
+    long int games, /* number of games to play */
+	turns, /* total turns processed in a pass */
+	g; /* game counter */
+    int path, /* path counter */
+	last, /* the last pass to make */
+	round; /* round counter */
+    clock_t ticks, /* processor time spent processing turns */
+	best[PATH_FILE + 1]; /* the best time of each pass */
+    double seconds; /* seconds spent in a pass */
+
+    /* get the parameters from the command line */
+    games = argc > 1 ? atol (argv[1]) : DEFAULT_GAMES;
+    seed = argc > 2 ? strtoul (argv[2], NULL, 10) : 1;
+    if (argc > 3)
+	for (math = MATH_INTEGER;
+	     math <= MATH_FLOAT && strcmp (argv[3], maths[math]);
+	     ++math);
+    if (games <= 0 || math > MATH_FLOAT) {
+	fprintf (stderr, "Usage: %s [games] [seed] [integer|float]"
+		 " [rules]\n", argv[0]);
+	return 1;
+    }
+    last = PATH_GENERIC;
+    if (argc > 4) {
+	stock_rules (&rules);
+	if (! (input = fopen (argv[4], "r"))) {
+	    fprintf (stderr, "Cannot open rules %s\n", argv[4]);
+	    return 1;
+	}
+	if (! read_rules (&rules, input)) {
+	    fprintf (stderr, "Invalid rules in %s\n", argv[4]);
+	    return 1;
+	}
+	fclose (input);
+	last = PATH_FILE;
+    }
+
+    /* play the same games on each path in turn, keeping the best */
+    turns = 0;
+    for (round = 0; round < ROUNDS; ++round)
+	for (path = PATH_STOCK; path <= last; ++path) {
+	    turns = 0;
+	    checksums[path] = 0;
+	    ticks = 0;
+	    for (g = 0; g < games; ++g)
+		turns += play_game (path, seed + g, &checksums[path],
+				    &ticks);
+	    if (! round || ticks < best[path])
+		best[path] = ticks > 0 ? ticks : 1;
+	}
+
+    /* report each path, and compare the stock path with the generic */
+    printf ("path      seconds    turns/second   checksum\n");
+    for (path = PATH_STOCK; path <= last; ++path) {
+	seconds = (double) best[path] / CLOCKS_PER_SEC;
+	printf ("%-7s %9.3f %15.1f   %08lx\n", paths[path],
+		seconds, turns / seconds, checksums[path]);
+    }
+    printf ("stock path speedup: %.2fx\n",
+	    (double) best[PATH_GENERIC] / best[PATH_STOCK]);
+    if (checksums[PATH_STOCK] != checksums[PATH_GENERIC]) {
+	fprintf (stderr, "The stock and generic paths disagree\n");
+	return 2;
+    }
+    return 0;
+}
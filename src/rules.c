@@ -0,0 +1,216 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Ruleset Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "rules.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const RULE_LINE is the longest line of a ruleset file. */
+#define RULE_LINE 80
+
+/** @struct rule_info describes one field of a ruleset. */
+typedef struct {
+
+    /** @var name is the field's name in a ruleset file. */
+    char *name;
+
+    /** @var offset is the field's place in the ruleset. */
+    size_t offset;
+
+    /** @var minimum is the least value allowed. */
+    int minimum;
+
+} rule_info_t;
+
+/** @def RULE_INFO describes a field of the ruleset structure. */
+#define RULE_INFO(field, minimum) \
+    {#field, offsetof (ruleset_t, field), minimum}
+
+/** @var rule_info are the fields of a ruleset, in order. */
+static rule_info_t rule_info[RULE_FIELDS] = {
+    RULE_INFO (population_per_gold, 1),
+    RULE_INFO (castle_cost, 1),
+    RULE_INFO (knight_cost, 1),
+    RULE_INFO (castles_tax, 0),
+    RULE_INFO (castles_per_tax, 1),
+    RULE_INFO (knights_tax, 0),
+    RULE_INFO (knights_per_tax, 1),
+    RULE_INFO (footmen_tax, 0),
+    RULE_INFO (footmen_per_tax, 1),
+    RULE_INFO (knight_value, 1),
+    RULE_INFO (castle_value, 0),
+    RULE_INFO (max_gold, 0),
+    RULE_INFO (max_castles, 0),
+    RULE_INFO (max_knights, 0),
+    RULE_INFO (max_footmen, 0)
+};
+
+/** @var stock is the stock ruleset. */
+static ruleset_t stock = STOCK_RULES;
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Get one of the fields of a ruleset.
+ * @param rules is the ruleset.
+ * @param f is the field number.
+ * @return a pointer to the field.
+ */
+int *rule_field (ruleset_t *rules, int f)
+{
+    return (int *) ((char *) rules + rule_info[f].offset);
+}
+
+/**
+ * Get the name of a field of a ruleset.
+ * @param f is the field number.
+ * @return the name of the field.
+ */
+char *rule_name (int f)
+{
+    return rule_info[f].name;
+}
+
+/**
+ * Get the least value allowed in a field of a ruleset.
+ * @param f is the field number.
+ * @return the least value.
+ */
+int rule_minimum (int f)
+{
+    return rule_info[f].minimum;
+}
+
+/**
+ * Find a field of a ruleset by name.
+ * @param name is the name of the field.
+ * @return the field number, or -1 if there is no such field.
+ */
+int find_rule (char *name)
+{
+    int f; /* field counter */
+    for (f = 0; f < RULE_FIELDS; ++f)
+	if (! strcmp (name, rule_info[f].name))
+	    return f;
+    return -1;
+}
+
+/**
+ * Set a ruleset to the stock rules.
+ * @param rules is the ruleset.
+ */
+void stock_rules (ruleset_t *rules)
+{
+    *rules = stock;
+}
+
+/**
+ * Check whether a ruleset is the stock rules.
+ * @param rules is the ruleset.
+ * @return 1 if it is, 0 if any field differs.
+ */
+int is_stock_rules (ruleset_t *rules)
+{
+    int f; /* field counter */
+    for (f = 0; f < RULE_FIELDS; ++f)
+	if (*rule_field (rules, f) != *rule_field (&stock, f))
+	    return 0;
+    return 1;
+}
+
+/**
+ * Check that a ruleset can be played.
+ * @param rules is the ruleset.
+ * @return 1 if it can, 0 if a field is out of range.
+ */
+int valid_rules (ruleset_t *rules)
+{
+    int f; /* field counter */
+    for (f = 0; f < RULE_FIELDS; ++f)
+	if (*rule_field (rules, f) < rule_info[f].minimum)
+	    return 0;
+    return 1;
+}
+
+/**
+ * Read the fields of a ruleset from a file.
+ * The ruleset is left unchanged unless the whole file is valid.
+ * @param rules is the ruleset to change.
+ * @param input is the file to read.
+ * @return 1 if successful, 0 if the file is not a valid ruleset.
+ */
+int read_rules (ruleset_t *rules, FILE *input)
+{
+    /* local variables */
+    char line[RULE_LINE + 2], /* line read from the file */
+	name[RULE_LINE + 1], /* name of a field */
+	extra[2], /* anything after the value */
+	*comment; /* start of any comment on the line */
+    long int value; /* value of a field */
+    int f; /* field number */
+    ruleset_t read; /* the ruleset as read so far */
+
+    /* read the lines, setting a field for each that is not blank */
+    read = *rules;
+    while (fgets (line, sizeof (line), input)) {
+	if (! strchr (line, '\n') && ! feof (input))
+	    return 0;
+	if ((comment = strchr (line, '#')))
+	    *comment = '\0';
+	switch (sscanf (line, "%80s %ld %1s", name, &value, extra)) {
+	case EOF:
+	    continue;
+	case 2:
+	    if ((f = find_rule (name)) != -1
+		&& value >= rule_info[f].minimum
+		&& value <= INT_MAX) {
+		*rule_field (&read, f) = (int) value;
+		continue;
+	    }
+	}
+	return 0;
+    }
+
+    /* accept the ruleset if the whole file was read */
+    if (ferror (input))
+	return 0;
+    *rules = read;
+    return 1;
+}
+
+/**
+ * Write a ruleset to a file in the form read_rules reads.
+ * @param rules is the ruleset.
+ * @param output is the file to write to.
+ * @return 1 if successful, 0 on error.
+ */
+int write_rules (ruleset_t *rules, FILE *output)
+{
+    int f; /* field counter */
+    for (f = 0; f < RULE_FIELDS; ++f)
+	fprintf (output, "%s %d\n", rule_info[f].name,
+		 *rule_field (rules, f));
+    return ! ferror (output);
+}
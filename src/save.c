@@ -0,0 +1,395 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Saved Game Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "save.h"
+#include "game.h"
+#include "barony.h"
+#include "order.h"
+#include "attack.h"
+#include "report.h"
+#include "rules.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+/**
+ * Count the attacks made in a game.
+ * @param game is the game.
+ * @return the number of attacks.
+ */
+static int count_attacks (game_t *game)
+{
+    int b, /* barony counter */
+	a, /* attack counter */
+	count; /* number of attacks */
+    unsigned long long int mask; /* dense attacks left to count */
+    count = 0;
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= mask - 1)
+	    ++count;
+    else
+	for (b = 0; b < game->barony_count; ++b)
+	    for (a = game->first_attack[b]; a != -1;
+		 a = game->attacks[a].next)
+		++count;
+    return count;
+}
+
+/**
+ * Put an attack into a snapshot.
+ * @param snapshot is the snapshot.
+ * @param place is the place of the attack.
+ * @param attack is the attack.
+ */
+static void put_attack (unsigned char *snapshot,
+			unsigned long int place, attack_t *attack)
+{
+    set_snapshot_value (snapshot, place, attack->origin);
+    set_snapshot_value (snapshot, place + 4, attack->target);
+    set_snapshot_value (snapshot, place + 8, attack->knights);
+    set_snapshot_value (snapshot, place + 12, attack->footmen);
+}
+
+/**
+ * Check that the counts in a snapshot's header are consistent.
+ * @param snapshot is the snapshot.
+ * @param size is the number of bytes available to read, or 0xffffffff
+ * if the rest of the snapshot is yet to be read.
+ * @return 1 if the header is valid, 0 if not.
+ */
+static int valid_header (unsigned char *snapshot,
+			 unsigned long int size)
+{
+    long int baronies, /* number of baronies */
+	attacks; /* number of attacks */
+    if (size < SNAPSHOT_HEADER
+	|| memcmp (snapshot, SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC)))
+	return 0;
+    baronies = snapshot_value (snapshot, SNAPSHOT_BARONIES);
+    attacks = snapshot_value (snapshot, SNAPSHOT_ATTACKS);
+    return baronies >= 2 && baronies <= MAX_BARONIES
+	&& attacks >= 0 && attacks <= baronies * (baronies - 1)
+	&& (unsigned long int) snapshot_value (snapshot, SNAPSHOT_SIZE)
+	== ATTACK_PLACE (baronies, attacks)
+	&& ATTACK_PLACE (baronies, attacks) <= size;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Work out the size of the snapshot of a game.
+ * @param game is the game.
+ * @return the size in bytes.
+ */
+unsigned long int snapshot_size (game_t *game)
+{
+    return ATTACK_PLACE (game->barony_count, count_attacks (game));
+}
+
+/**
+ * Write the snapshot of a game to memory.
+ * @param game is the game.
+ * @param snapshot is a block of snapshot_size bytes.
+ */
+void write_snapshot (game_t *game, unsigned char *snapshot)
+{
+    /* local variables */
+    int b, /* barony counter */
+	f, /* field counter */
+	a, /* attack counter */
+	count, /* number of attacks */
+	baronies; /* number of baronies */
+    unsigned long int place; /* place of a barony or order */
+    unsigned long long int mask; /* dense attacks left to write */
+    barony_t *barony; /* shorthand pointer to a barony */
+    order_t *order; /* shorthand pointer to an order */
+
+    /* write the header */
+    baronies = game->barony_count;
+    count = count_attacks (game);
+    memset (snapshot, 0, SNAPSHOT_HEADER);
+    memcpy (snapshot, SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC));
+    set_snapshot_value (snapshot, SNAPSHOT_SIZE,
+			ATTACK_PLACE (baronies, count));
+    set_snapshot_value (snapshot, SNAPSHOT_BARONIES, baronies);
+    set_snapshot_value (snapshot, SNAPSHOT_TURN, game->turn);
+    set_snapshot_value (snapshot, SNAPSHOT_SEED, game->seed);
+    for (f = 0; f < 4; ++f)
+	set_snapshot_value (snapshot, SNAPSHOT_RNG + 4 * f,
+			    game->rng.state[f]);
+    set_snapshot_value (snapshot, SNAPSHOT_REPORTS,
+			game->report_policy);
+    set_snapshot_value (snapshot, SNAPSHOT_MATH, game->battle_math);
+    set_snapshot_value (snapshot, SNAPSHOT_ATTACKS, count);
+    for (f = 0; f < RULE_FIELDS; ++f)
+	set_snapshot_value (snapshot, SNAPSHOT_RULES + 4 * f,
+			    *rule_field (&game->rules, f));
+
+    /* write the baronies and their orders */
+    for (b = 0; b < baronies; ++b) {
+	barony = &game->baronies[b];
+	place = BARONY_PLACE (b);
+	memset (snapshot + place, 0, SNAPSHOT_NAME);
+	strcpy ((char *) snapshot + place, barony->name);
+	set_snapshot_value (snapshot, place + SNAPSHOT_NAME,
+			    barony->control);
+	for (f = 0; f < BARONY_FIELDS; ++f)
+	    set_snapshot_value (snapshot,
+				place + SNAPSHOT_NAME + 4 + 4 * f,
+				*barony_field (barony, f));
+	order = &game->orders[b];
+	place = ORDER_PLACE (baronies, b);
+	set_snapshot_value (snapshot, place, order->placed);
+	set_snapshot_value (snapshot, place + 4, order->castles);
+	set_snapshot_value (snapshot, place + 8, order->knights);
+	set_snapshot_value (snapshot, place + 12, order->footmen);
+	set_snapshot_value (snapshot, place + 16, order->paid);
+    }
+
+    /* write the rankings */
+    for (b = 0; b < baronies; ++b)
+	set_snapshot_value (snapshot, RANK_PLACE (baronies, b),
+			    game->ranks[b].barony);
+
+    /* write the attacks in order of origin and target */
+    count = 0;
+    if (DENSE_ATTACKS (game))
+	for (mask = game->attack_mask; mask; mask &= mask - 1) {
+	    a = lowest_attack (mask);
+	    put_attack (snapshot, ATTACK_PLACE (baronies, count++),
+			&game->attacks[a]);
+	}
+    else
+	for (b = 0; b < baronies; ++b)
+	    for (a = game->first_attack[b]; a != -1;
+		 a = game->attacks[a].next)
+		put_attack (snapshot, ATTACK_PLACE (baronies, count++),
+			    &game->attacks[a]);
+}
+
+/**
+ * Get a value from a snapshot in place.
+ * @param snapshot is the snapshot.
+ * @param place is the place of the value.
+ * @return the value.
+ */
+long int snapshot_value (unsigned char *snapshot,
+			 unsigned long int place)
+{
+    unsigned long int word; /* the value as a 32-bit word */
+    word = snapshot[place]
+	| (unsigned long int) snapshot[place + 1] << 8
+	| (unsigned long int) snapshot[place + 2] << 16
+	| (unsigned long int) snapshot[place + 3] << 24;
+    return word & 0x80000000UL
+	? -(long int) (~word & 0x7fffffffUL) - 1
+	: (long int) word;
+}
+
+/**
+ * Put a value into a snapshot.
+ * @param snapshot is the snapshot.
+ * @param place is the place of the value.
+ * @param value is the value, which must fit in 32 bits.
+ */
+void set_snapshot_value (unsigned char *snapshot,
+			 unsigned long int place, long int value)
+{
+    unsigned long int word; /* the value as a 32-bit word */
+    word = (unsigned long int) value & 0xffffffffUL;
+    snapshot[place] = (unsigned char) (word & 0xff);
+    snapshot[place + 1] = (unsigned char) ((word >> 8) & 0xff);
+    snapshot[place + 2] = (unsigned char) ((word >> 16) & 0xff);
+    snapshot[place + 3] = (unsigned char) ((word >> 24) & 0xff);
+}
+
+/**
+ * Create a game from a snapshot in memory.
+ * @param snapshot is the snapshot.
+ * @param size is the number of bytes available to read.
+ * @return the game, or NULL if the snapshot is not valid.
+ */
+game_t *read_snapshot (unsigned char *snapshot, unsigned long int size)
+{
+    /* local variables */
+    game_t *game; /* the game to return */
+    int b, /* barony counter */
+	f, /* field counter */
+	a, /* attack counter */
+	baronies, /* number of baronies */
+	attacks, /* number of attacks */
+	origin, /* origin of an attack */
+	target; /* target of an attack */
+    long int control, /* control of a barony */
+	ranked; /* barony in a place in the rankings */
+    unsigned long int place; /* place of a barony, order or attack */
+    barony_t *barony; /* shorthand pointer to a barony */
+    order_t *order; /* shorthand pointer to an order */
+    ruleset_t rules; /* the rules the game is played to */
+    char *seen; /* marks the baronies found in the rankings */
+
+    /* check the header and create the game */
+    if (! valid_header (snapshot, size)
+	|| snapshot_value (snapshot, SNAPSHOT_REPORTS) < REPORT_ALL
+	|| snapshot_value (snapshot, SNAPSHOT_REPORTS) > REPORT_NONE
+	|| snapshot_value (snapshot, SNAPSHOT_MATH) < MATH_INTEGER
+	|| snapshot_value (snapshot, SNAPSHOT_MATH) > MATH_FLOAT)
+	return NULL;
+    baronies = (int) snapshot_value (snapshot, SNAPSHOT_BARONIES);
+    attacks = (int) snapshot_value (snapshot, SNAPSHOT_ATTACKS);
+    game = new_game (baronies);
+
+    /* read the turn, the random number generator and the options */
+    game->turn = (int) snapshot_value (snapshot, SNAPSHOT_TURN);
+    game->seed = (unsigned long int)
+	snapshot_value (snapshot, SNAPSHOT_SEED) & 0xffffffffUL;
+    for (f = 0; f < 4; ++f)
+	game->rng.state[f] = (unsigned long int)
+	    snapshot_value (snapshot, SNAPSHOT_RNG + 4 * f)
+	    & 0xffffffffUL;
+    game->report_policy = (report_policy_t)
+	snapshot_value (snapshot, SNAPSHOT_REPORTS);
+    game->battle_math = (battle_math_t)
+	snapshot_value (snapshot, SNAPSHOT_MATH);
+
+    /* read the rules, which must be playable */
+    for (f = 0; f < RULE_FIELDS; ++f)
+	*rule_field (&rules, f) = (int) snapshot_value
+	    (snapshot, SNAPSHOT_RULES + 4 * f);
+    if (! set_rules (game, &rules)) {
+	end_game (game);
+	return NULL;
+    }
+
+    /* read the baronies and their orders */
+    for (b = 0; b < baronies; ++b) {
+	barony = &game->baronies[b];
+	place = BARONY_PLACE (b);
+	control = snapshot_value (snapshot, place + SNAPSHOT_NAME);
+	if (! memchr (snapshot + place, 0, sizeof (barony->name))
+	    || control < CONTROL_HUMAN || control > CONTROL_REMOTE) {
+	    end_game (game);
+	    return NULL;
+	}
+	strcpy (barony->name, (char *) snapshot + place);
+	barony->control = (control_t) control;
+	for (f = 0; f < BARONY_FIELDS; ++f)
+	    *barony_field (barony, f) = (int) snapshot_value
+		(snapshot, place + SNAPSHOT_NAME + 4 + 4 * f);
+	place = ORDER_PLACE (baronies, b);
+	if (snapshot_value (snapshot, place)) {
+	    order = set_order
+		(game, b,
+		 (int) snapshot_value (snapshot, place + 4),
+		 (int) snapshot_value (snapshot, place + 8),
+		 (int) snapshot_value (snapshot, place + 12));
+	    order->paid = (int) snapshot_value (snapshot, place + 16);
+	}
+    }
+
+    /* read the rankings, which must list each barony once */
+    if (! (seen = calloc (baronies, sizeof (char))))
+	fatal_error (FATAL_MEMORY);
+    for (b = 0; b < baronies; ++b) {
+	ranked = snapshot_value (snapshot, RANK_PLACE (baronies, b));
+	if (ranked < 0 || ranked >= baronies || seen[ranked]) {
+	    free (seen);
+	    end_game (game);
+	    return NULL;
+	}
+	seen[ranked] = 1;
+	game->ranks[b].barony = (int) ranked;
+	game->ranks[b].land = game->baronies[ranked].land;
+    }
+    free (seen);
+
+    /* read the attacks */
+    for (a = 0; a < attacks; ++a) {
+	place = ATTACK_PLACE (baronies, a);
+	origin = (int) snapshot_value (snapshot, place);
+	target = (int) snapshot_value (snapshot, place + 4);
+	if (origin < 0 || origin >= baronies
+	    || target < 0 || target >= baronies || origin == target
+	    || ! new_attack
+	    (game, origin, target,
+	     (int) snapshot_value (snapshot, place + 8),
+	     (int) snapshot_value (snapshot, place + 12))) {
+	    end_game (game);
+	    return NULL;
+	}
+    }
+
+    /* return the game */
+    return game;
+}
+
+/**
+ * Save a game to a file.
+ * @param game is the game to save.
+ * @param output is the file to write to.
+ * @return 1 if the game was saved, 0 if the file could not be written.
+ */
+int game_save (game_t *game, FILE *output)
+{
+    unsigned char *snapshot; /* the snapshot to write */
+    unsigned long int size; /* the size of the snapshot */
+    int saved; /* 1 if the snapshot was written */
+    size = snapshot_size (game);
+    if ((size_t) size != size || ! (snapshot = malloc ((size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    write_snapshot (game, snapshot);
+    saved = fwrite (snapshot, (size_t) size, 1, output) == 1;
+    free (snapshot);
+    return saved;
+}
+
+/**
+ * Load a game from a file.
+ * @param input is the file to read from.
+ * @return the game, or NULL if no valid snapshot could be read.
+ */
+game_t *game_load (FILE *input)
+{
+    unsigned char header[SNAPSHOT_HEADER], /* the snapshot header */
+	*snapshot; /* the whole snapshot */
+    unsigned long int size; /* the size of the snapshot */
+    game_t *game; /* the game to return */
+
+    /* read and check the header */
+    if (fread (header, SNAPSHOT_HEADER, 1, input) != 1
+	|| ! valid_header (header, 0xffffffffUL))
+	return NULL;
+    size = (unsigned long int) snapshot_value (header, SNAPSHOT_SIZE);
+
+    /* read the rest of the snapshot and make a game of it */
+    if ((size_t) size != size || ! (snapshot = malloc ((size_t) size)))
+	fatal_error (FATAL_MEMORY);
+    memcpy (snapshot, header, SNAPSHOT_HEADER);
+    if (fread (snapshot + SNAPSHOT_HEADER, (size_t) size
+	       - SNAPSHOT_HEADER, 1, input) != 1)
+	game = NULL;
+    else
+	game = read_snapshot (snapshot, size);
+    free (snapshot);
+    return game;
+}
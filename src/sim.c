@@ -0,0 +1,204 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Headless Simulation Module.
+ * Plays all-computer games without a display and reports throughput.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "hash.h"
+#include "report.h"
+#include "journal.h"
+#include "stats.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_GAMES is the number of games played by default. */
+#define DEFAULT_GAMES 10000
+
+/** @var policies are the names of the report policies. */
+static char *policies[] = {
+    "all",
+    "players",
+    "none"
+};
+
+/** @var policy is the report policy for the simulated games. */
+static report_policy_t policy = REPORT_NONE;
+
+/** @var maths are the names of the battle arithmetic options. */
+static char *maths[] = {
+    "integer",
+    "float"
+};
+
+/** @var math is the battle arithmetic for the simulated games. */
+static battle_math_t math = MATH_INTEGER;
+
+/** @var baronies is the number of baronies in each game. */
+static int baronies = BARONIES;
+
+/** @var journal is the journal the games are recorded in. */
+static journal_t *journal = NULL;
+
+/** @var stats are the turn statistics of all the games. */
+static game_stats_t stats;
+
+/** @var timed is 1 if the library keeps turn statistics. */
+static int timed = 0;
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Play a single all-computer game from start to finish.
+ * @param seed is the random number seed for the game.
+ * @param checksum points to the running checksum of final states.
+ * @return the number of turns processed.
+ */
+static long int play_game (unsigned long int seed,
+			   unsigned long int *checksum)
+{
+    game_t *game; /* the game to play */
+    long int turns; /* number of turns processed */
+
+    /* start the game and record it in any journal */
+    game = new_game (baronies);
+    seed_game (game, seed);
+    game->report_policy = policy;
+    game->battle_math = math;
+    if (journal && ! journal_game (journal, game)) {
+	fprintf (stderr, "Cannot write to the journal\n");
+	exit (2);
+    }
+
+    /* play every turn of the game */
+    for (turns = 0; game->turn < TURNS; ++turns) {
+	computer_turns (game);
+	if (! journal)
+	    process_turn (game);
+	else if (! process_turn_journal (game, journal)) {
+	    fprintf (stderr, "Cannot write to the journal\n");
+	    exit (2);
+	}
+    }
+
+    /* gather the statistics, clean up and return */
+    *checksum = checksum_game (*checksum, game);
+    if (get_game_stats (game)) {
+	add_game_stats (&stats, get_game_stats (game));
+	timed = 1;
+    }
+    end_game (game);
+    return turns;
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The simulator has no display, but the fatal error handler expects
+ * one to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    FILE *output; /* the journal file */
+    unsigned long int seed, /* seed for the first game */
+	checksum; /* checksum of the final game states */
+    long int games, /* number of games to play */
+	turns, /* total turns processed */
+	g; /* game counter */
+    clock_t start; /* processor time at the start */
+    double seconds; /* seconds elapsed */
+
+    /* get the number of games and seed from the command line */
+    games = argc > 1 ? atol (argv[1]) : DEFAULT_GAMES;
+    seed = argc > 2 ? strtoul (argv[2], NULL, 10) : 1;
+    if (argc > 3)
+	for (policy = REPORT_ALL;
+	     policy <= REPORT_NONE
+		 && strcmp (argv[3], policies[policy]);
+	     ++policy);
+    if (argc > 4)
+	for (math = MATH_INTEGER;
+	     math <= MATH_FLOAT && strcmp (argv[4], maths[math]);
+	     ++math);
+    if (argc > 5)
+	baronies = atoi (argv[5]);
+    if (games <= 0 || policy > REPORT_NONE || math > MATH_FLOAT
+	|| baronies < 2 || baronies > MAX_BARONIES) {
+	fprintf (stderr, "Usage: %s [games] [seed] [all|players|none]"
+		 " [integer|float] [baronies] [journal]\n", argv[0]);
+	return 1;
+    }
+    output = NULL;
+    if (argc > 6
+	&& (! (output = fopen (argv[6], "a+b"))
+	    || ! (journal = new_journal (output, JOURNAL_INTERVAL)))) {
+	fprintf (stderr, "Cannot open journal %s\n", argv[6]);
+	return 1;
+    }
+
+    /* play the games */
+    turns = 0;
+    checksum = 0;
+    start = clock ();
+    for (g = 0; g < games; ++g)
+	turns += play_game (seed + g, &checksum);
+    seconds = (double) (clock () - start) / CLOCKS_PER_SEC;
+    if (seconds <= 0)
+	seconds = 1.0 / CLOCKS_PER_SEC;
+
+    /* report the throughput */
+    printf ("games: %ld   turns: %ld   seconds: %.3f\n",
+	    games, turns, seconds);
+    printf ("baronies: %d   reports: %s   arithmetic: %s\n",
+	    baronies, policies[policy], maths[math]);
+    printf ("games/second: %.1f   turns/second: %.1f\n",
+	    games / seconds, turns / seconds);
+    printf ("checksum: %08lx\n", checksum);
+    if (timed) {
+	printf ("\n");
+	dump_game_stats (stdout, &stats);
+    }
+    if (journal && (! end_journal (journal) || fclose (output))) {
+	fprintf (stderr, "Cannot write to the journal\n");
+	return 2;
+    }
+    return 0;
+}
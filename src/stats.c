@@ -0,0 +1,129 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Turn Statistics Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "stats.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var stage_names are the names of the stages. */
+static char *stage_names[] = {
+    "computer_turns",
+    "clear_reports",
+    "take_payments",
+    "fight_battles",
+    "deliver_units",
+    "process_economy",
+    "calculate_rankings"
+};
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Read the high-resolution clock.
+ * Where there is no monotonic clock, the processor clock stands in.
+ * @return the time in nanoseconds from some fixed point.
+ */
+stats_time_t stats_clock (void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec now; /* current time */
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (stats_time_t) now.tv_sec * 1000000000 + now.tv_nsec;
+#else
+    return (stats_time_t) clock () * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+/**
+ * Count a call to a stage and the time spent in it.
+ * @param stats are the statistics to add to.
+ * @param stage is the stage.
+ * @param start is the time the stage started.
+ */
+void stage_done (game_stats_t *stats, stage_t stage,
+		 stats_time_t start)
+{
+    ++stats->calls[stage];
+    stats->nanoseconds[stage] += stats_clock () - start;
+}
+
+/**
+ * Clear a set of statistics.
+ * @param stats are the statistics to clear.
+ */
+void clear_game_stats (game_stats_t *stats)
+{
+    memset (stats, 0, sizeof (game_stats_t));
+}
+
+/**
+ * Add one set of statistics to another.
+ * @param total are the statistics to add to.
+ * @param stats are the statistics to add.
+ */
+void add_game_stats (game_stats_t *total, game_stats_t *stats)
+{
+    int s; /* stage counter */
+    for (s = 0; s < STAGES; ++s) {
+	total->calls[s] += stats->calls[s];
+	total->nanoseconds[s] += stats->nanoseconds[s];
+    }
+}
+
+/**
+ * Get the name of a stage.
+ * @param stage is the stage.
+ * @return the name of the function that carries it out.
+ */
+char *stage_name (stage_t stage)
+{
+    return stage_names[stage];
+}
+
+/**
+ * Write a table of statistics.
+ * @param output is the file to write to.
+ * @param stats are the statistics.
+ */
+void dump_game_stats (FILE *output, game_stats_t *stats)
+{
+    int s; /* stage counter */
+    stats_time_t total; /* time spent in all stages */
+
+    /* total the time, to give each stage its share */
+    for (total = s = 0; s < STAGES; ++s)
+	total += stats->nanoseconds[s];
+    if (! total)
+	total = 1;
+
+    /* write a line for each stage */
+    fprintf (output, "stage                   calls     seconds"
+	     "   ns/call   share\n");
+    for (s = 0; s < STAGES; ++s)
+	fprintf (output, "%-18s %10lu %11.3f %9.1f %6.1f%%\n",
+		 stage_names[s], stats->calls[s],
+		 stats->nanoseconds[s] / 1e9,
+		 stats->calls[s]
+		 ? (double) stats->nanoseconds[s] / stats->calls[s]
+		 : 0.0,
+		 100.0 * stats->nanoseconds[s] / total);
+}
@@ -0,0 +1,596 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Ruleset Sweep Module.
+ * Plays many all-computer games at each of a set of rulesets, over
+ * all the processors, and streams the outcome at each ruleset to a
+ * compact file as it is finished.
+ *
+ * The rulesets are described by a sweep file. Each line names a
+ * field of the ruleset and the values to try, from a first to a last
+ * value in steps; the last value and the step may be left out. The
+ * rulesets are every combination of the values, unless a "samples"
+ * line asks for that many drawn at random. Fields not named keep
+ * their stock values. For example:
+ *
+ *   # a comment
+ *   samples 200
+ *   castle_cost 60 140 20
+ *   knight_cost 8 12
+ *   knights_tax 2
+ *
+ * Every ruleset is played with the same seeds, so that differences
+ * between them come from the rules and not from the dice.
+ *
+ * The output file is a block of 32-bit little-endian numbers, as a
+ * snapshot is. Its header is SWEEP_MAGIC, then RULE_FIELDS,
+ * BARONIES, TURNS, the games per ruleset, the first seed and the
+ * number of rulesets, then the name of each field in SWEEP_NAME
+ * bytes padded with nulls. A record follows for each ruleset:
+ *
+ *   rules     the value of each field
+ *   games     the number of games played
+ *   checksum  the sum of anarchic-batch's checksums of the games
+ *   decided   for each turn, the games whose winner took the lead
+ *             for good on that turn
+ *   places    for each barony, the games it finished in each place
+ *   land      for each place, the total final land of the barony
+ *             in it, as a low word and a high word
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/* POSIX headers */
+#include <pthread.h>
+#include <unistd.h>
+
+/* project headers */
+#include "anarchic.h"
+#include "game.h"
+#include "computer.h"
+#include "hash.h"
+#include "report.h"
+#include "rules.h"
+#include "random.h"
+#include "save.h"
+#include "fatal.h"
+#include "display.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @const DEFAULT_GAMES is the number of games played by default. */
+#define DEFAULT_GAMES 1000
+
+/** @const CHUNK is the number of games in a unit of work. */
+#define CHUNK 16
+
+/** @const SWEEP_LINE is the longest line of a sweep file. */
+#define SWEEP_LINE 80
+
+/** @def SWEEP_MAGIC identifies a sweep file and its version. */
+#define SWEEP_MAGIC "ANK100W"
+
+/** @const SWEEP_NAME is the space for a field name in the header. */
+#define SWEEP_NAME 20
+
+/** @const SWEEP_HEADER is the size of the header in bytes. */
+#define SWEEP_HEADER (32 + RULE_FIELDS * SWEEP_NAME)
+
+/* places of the parts of a record */
+#define RECORD_GAMES (RULE_FIELDS * 4)
+#define RECORD_CHECKSUM (RECORD_GAMES + 4)
+#define RECORD_DECIDED (RECORD_CHECKSUM + 4)
+#define RECORD_PLACES (RECORD_DECIDED + TURNS * 4)
+#define RECORD_LAND (RECORD_PLACES + BARONIES * BARONIES * 4)
+#define RECORD_SIZE (RECORD_LAND + BARONIES * 8)
+
+/* typedefs */
+typedef struct axis axis_t;
+typedef struct tally tally_t;
+typedef struct worker worker_t;
+
+/** @struct axis is a field of the ruleset and the values it takes. */
+struct axis {
+
+    /** @var field is the field number. */
+    int field;
+
+    /** @var from is the first value. */
+    int from;
+
+    /** @var step is the difference between values. */
+    int step;
+
+    /** @var values is the number of values. */
+    int values;
+
+};
+
+/** @struct tally accumulates the outcome of games at one ruleset. */
+struct tally {
+
+    /** @var games is the number of games played. */
+    long int games;
+
+    /** @var checksum is the sum of per-game state checksums. */
+    unsigned long int checksum;
+
+    /** @var decided counts the turns on which games were decided. */
+    long int decided[TURNS];
+
+    /** @var places counts each barony's finishing places. */
+    long int places[BARONIES][BARONIES];
+
+    /** @var land is the total final land at each place. */
+    unsigned long long int land[BARONIES];
+
+};
+
+/** @struct worker is the state of one worker thread. */
+struct worker {
+
+    /** @var thread is the POSIX thread running the worker. */
+    pthread_t thread;
+
+    /** @var game is the worker's game, reused for every game. */
+    game_t *game;
+
+    /** @var tally is the worker's tally at the current ruleset. */
+    tally_t tally;
+
+};
+
+/** @var axes are the fields swept. */
+static axis_t axes[RULE_FIELDS];
+
+/** @var axis_count is the number of fields swept. */
+static int axis_count = 0;
+
+/** @var samples is the number of rulesets to draw, or 0 for all. */
+static long int samples = 0;
+
+/** @var start is the starting position at the current ruleset. */
+static game_t *start;
+
+/** @var lock serialises the handing out of games. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** @var next_game is the next game to hand out. */
+static long int next_game;
+
+/** @var games is the number of games to play at each ruleset. */
+static long int games;
+
+/** @var seed is the seed of the first game. */
+static unsigned long int seed;
+
+/*----------------------------------------------------------------------
+ * Level 2 Routines.
+ */
+
+/**
+ * Play a single all-computer game and add it to a tally.
+ * The worker's game is overwritten with the starting position, so
+ * that no memory is allocated.
+ * @param worker is the worker to play the game.
+ * @param g is the number of the game.
+ */
+static void play_game (worker_t *worker, long int g)
+{
+    game_t *game; /* the game to play */
+    tally_t *tally; /* shorthand pointer to the tally */
+    int b, /* barony counter */
+	leader, /* the barony leading the rankings */
+	decided; /* the turn the leader took the lead */
+
+    /* play every turn of the game, watching the lead */
+    game = worker->game;
+    game_copy_into (game, start);
+    seed_game (game, seed + g);
+    leader = -1;
+    decided = 1;
+    while (game->turn < TURNS) {
+	computer_turns (game);
+	process_turn (game);
+	if (game->ranks[0].barony != leader) {
+	    leader = game->ranks[0].barony;
+	    decided = game->turn;
+	}
+    }
+
+    /* accumulate the outcome */
+    tally = &worker->tally;
+    ++tally->games;
+    tally->checksum
+	= (tally->checksum + checksum_game (0, game)) & 0xffffffffUL;
+    ++tally->decided[decided - 1];
+    for (b = 0; b < BARONIES; ++b) {
+	++tally->places[b][game->baronies[b].ranking - 1];
+	tally->land[b] += game->baronies[game->ranks[b].barony].land;
+    }
+}
+
+/**
+ * Take a chunk of games to play at the current ruleset.
+ * @param chunk receives the first game of the chunk.
+ * @return 1 if a chunk was taken, 0 if every game has been taken.
+ */
+static int take_chunk (long int *chunk)
+{
+    pthread_mutex_lock (&lock);
+    *chunk = next_game;
+    next_game += CHUNK;
+    pthread_mutex_unlock (&lock);
+    return *chunk < games;
+}
+
+/**
+ * Put a string into a sweep file's header, padded with nulls.
+ * @param header is the header.
+ * @param place is the place of the string.
+ * @param string is the string.
+ * @param size is the space for it.
+ */
+static void put_string (unsigned char *header, int place,
+			char *string, int size)
+{
+    memset (header + place, 0, size);
+    strncpy ((char *) header + place, string, size - 1);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Read the fields to sweep from a sweep file.
+ * @param input is the sweep file.
+ * @return the number of rulesets, or 0 if the file is not valid.
+ */
+static long int read_sweep (FILE *input)
+{
+    /* local variables */
+    char line[SWEEP_LINE + 2], /* line read from the file */
+	name[SWEEP_LINE + 1], /* name of a field */
+	extra[2], /* anything after the values */
+	*comment; /* start of any comment on the line */
+    long int from, /* first value of a field */
+	to, /* last value of a field */
+	step, /* step between values */
+	points; /* number of rulesets */
+    int f, /* field number */
+	a, /* axis counter */
+	read; /* number of items read from a line */
+    axis_t *axis; /* shorthand pointer to an axis */
+
+    /* read the lines, taking an axis from each that is not blank */
+    while (fgets (line, sizeof (line), input)) {
+	if (! strchr (line, '\n') && ! feof (input))
+	    return 0;
+	if ((comment = strchr (line, '#')))
+	    *comment = '\0';
+	read = sscanf (line, "%80s %ld %ld %ld %1s", name, &from, &to,
+		       &step, extra);
+	if (read == EOF)
+	    continue;
+	if (read == 2 && ! strcmp (name, "samples") && from > 0) {
+	    samples = from;
+	    continue;
+	}
+	if (read < 2 || read > 4 || (f = find_rule (name)) == -1)
+	    return 0;
+	if (read < 3)
+	    to = from;
+	if (read < 4)
+	    step = 1;
+	for (a = 0; a < axis_count && axes[a].field != f; ++a);
+	if (a < axis_count || from < rule_minimum (f) || to < from
+	    || to > INT_MAX || step < 1
+	    || (to - from) / step >= INT_MAX)
+	    return 0;
+	axis = &axes[axis_count++];
+	axis->field = f;
+	axis->from = from;
+	axis->step = step;
+	axis->values = (to - from) / step + 1;
+    }
+    if (ferror (input))
+	return 0;
+
+    /* count the rulesets */
+    if (samples)
+	return samples;
+    for (points = 1, a = 0; a < axis_count; ++a)
+	if (points > LONG_MAX / axes[a].values)
+	    return 0;
+	else
+	    points *= axes[a].values;
+    return points;
+}
+
+/**
+ * Set out the ruleset at one point of the sweep.
+ * @param rules receives the ruleset.
+ * @param p is the point's number.
+ * @param rng draws the values of a random sample.
+ */
+static void point_rules (ruleset_t *rules, long int p, random_t *rng)
+{
+    int a, /* axis counter */
+	v; /* value number on an axis */
+    stock_rules (rules);
+    for (a = axis_count - 1; a >= 0; --a) {
+	if (samples)
+	    v = random_number (rng, axes[a].values);
+	else {
+	    v = p % axes[a].values;
+	    p /= axes[a].values;
+	}
+	*rule_field (rules, axes[a].field)
+	    = axes[a].from + v * axes[a].step;
+    }
+}
+
+/**
+ * Worker thread: play chunks of games until none are left.
+ * @param arg points to the worker's state.
+ * @return NULL.
+ */
+static void *work (void *arg)
+{
+    worker_t *worker; /* this worker */
+    long int chunk, /* first game of the current chunk */
+	g; /* game counter */
+    worker = arg;
+    while (take_chunk (&chunk))
+	for (g = chunk; g < chunk + CHUNK && g < games; ++g)
+	    play_game (worker, g);
+    return NULL;
+}
+
+/**
+ * Play all the games at one ruleset over the workers.
+ * @param workers are the workers.
+ * @param threads is the number of workers.
+ * @param total receives the merged tally.
+ */
+static void sweep_point (worker_t *workers, int threads,
+			 tally_t *total)
+{
+    int w, /* worker counter */
+	b, /* barony counter */
+	p, /* place counter */
+	t; /* turn counter */
+    tally_t *tally; /* shorthand pointer to a worker's tally */
+
+    /* run the workers */
+    next_game = 0;
+    for (w = 0; w < threads; ++w) {
+	memset (&workers[w].tally, 0, sizeof (tally_t));
+	if (pthread_create (&workers[w].thread, NULL, work,
+			    &workers[w]))
+	    fatal_error (FATAL_MEMORY);
+    }
+    for (w = 0; w < threads; ++w)
+	pthread_join (workers[w].thread, NULL);
+
+    /* merge their tallies */
+    memset (total, 0, sizeof (tally_t));
+    for (w = 0; w < threads; ++w) {
+	tally = &workers[w].tally;
+	total->games += tally->games;
+	total->checksum = (total->checksum + tally->checksum)
+	    & 0xffffffffUL;
+	for (t = 0; t < TURNS; ++t)
+	    total->decided[t] += tally->decided[t];
+	for (b = 0; b < BARONIES; ++b) {
+	    for (p = 0; p < BARONIES; ++p)
+		total->places[b][p] += tally->places[b][p];
+	    total->land[b] += tally->land[b];
+	}
+    }
+}
+
+/**
+ * Write the header of a sweep file.
+ * @param output is the sweep file.
+ * @param points is the number of rulesets.
+ * @return 1 if successful, 0 on error.
+ */
+static int write_header (FILE *output, long int points)
+{
+    unsigned char header[SWEEP_HEADER]; /* the header */
+    int f; /* field counter */
+    memset (header, 0, 8);
+    memcpy (header, SWEEP_MAGIC, sizeof (SWEEP_MAGIC));
+    set_snapshot_value (header, 8, RULE_FIELDS);
+    set_snapshot_value (header, 12, BARONIES);
+    set_snapshot_value (header, 16, TURNS);
+    set_snapshot_value (header, 20, games);
+    set_snapshot_value (header, 24, seed & 0xffffffffUL);
+    set_snapshot_value (header, 28, points);
+    for (f = 0; f < RULE_FIELDS; ++f)
+	put_string (header, 32 + f * SWEEP_NAME, rule_name (f),
+		    SWEEP_NAME);
+    return fwrite (header, SWEEP_HEADER, 1, output) == 1;
+}
+
+/**
+ * Write the record of one ruleset to a sweep file.
+ * @param output is the sweep file.
+ * @param record is room for the record.
+ * @param rules is the ruleset.
+ * @param total is the tally of its games.
+ * @return 1 if successful, 0 on error.
+ */
+static int write_record (FILE *output, unsigned char *record,
+			 ruleset_t *rules, tally_t *total)
+{
+    int f, /* field counter */
+	b, /* barony counter */
+	p, /* place counter */
+	t; /* turn counter */
+    for (f = 0; f < RULE_FIELDS; ++f)
+	set_snapshot_value (record, f * 4, *rule_field (rules, f));
+    set_snapshot_value (record, RECORD_GAMES, total->games);
+    set_snapshot_value (record, RECORD_CHECKSUM, total->checksum);
+    for (t = 0; t < TURNS; ++t)
+	set_snapshot_value (record, RECORD_DECIDED + t * 4,
+			    total->decided[t]);
+    for (b = 0; b < BARONIES; ++b) {
+	for (p = 0; p < BARONIES; ++p)
+	    set_snapshot_value
+		(record, RECORD_PLACES + (b * BARONIES + p) * 4,
+		 total->places[b][p]);
+	set_snapshot_value (record, RECORD_LAND + b * 8,
+			    total->land[b] & 0xffffffffUL);
+	set_snapshot_value (record, RECORD_LAND + b * 8 + 4,
+			    total->land[b] >> 32);
+    }
+    return fwrite (record, RECORD_SIZE, 1, output) == 1
+	&& ! fflush (output);
+}
+
+/**
+ * Show a summary of one ruleset's games.
+ * @param p is the point's number.
+ * @param rules is the ruleset.
+ * @param total is the tally of its games.
+ */
+static void show_point (long int p, ruleset_t *rules, tally_t *total)
+{
+    int a, /* axis counter */
+	t; /* turn counter */
+    double decided; /* mean turn on which games were decided */
+    printf ("%7ld", p);
+    for (a = 0; a < axis_count; ++a)
+	printf (" %*d", (int) strlen (rule_name (axes[a].field)),
+		*rule_field (rules, axes[a].field));
+    for (decided = t = 0; t < TURNS; ++t)
+	decided += (t + 1.0) * total->decided[t];
+    printf (" %9.1f %9.1f %9.2f   %08lx\n",
+	    (double) total->land[0] / total->games,
+	    (double) total->land[BARONIES - 1] / total->games,
+	    decided / total->games, total->checksum);
+}
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Clean up the display handler.
+ * The sweep has no display, but the fatal error handler expects one
+ * to close.
+ */
+void display_close (void)
+{
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main function.
+ * @param argc is the number of command line arguments.
+ * @param argv is an array of command line arguments.
+ * @return 0 if successful, >0 on error.
+ */
+int main (int argc, char **argv)
+{
+    FILE *input, /* the sweep file */
+	*output; /* the output file */
+    long int points, /* number of rulesets */
+	p; /* point counter */
+    int threads, /* number of worker threads */
+	w, /* worker counter */
+	a; /* axis counter */
+    worker_t *workers; /* the workers */
+    unsigned char *record; /* room for a record */
+    ruleset_t rules; /* the ruleset at a point */
+    random_t rng; /* generator for random samples */
+    tally_t total; /* merged tally at a point */
+
+    /* get the parameters from the command line */
+    if (argc < 3) {
+	fprintf (stderr, "Usage: %s sweep output [games] [threads]"
+		 " [seed]\n", argv[0]);
+	return 1;
+    }
+    games = argc > 3 ? atol (argv[3]) : DEFAULT_GAMES;
+    threads = argc > 4 ? atoi (argv[4])
+	: (int) sysconf (_SC_NPROCESSORS_ONLN);
+    seed = argc > 5 ? strtoul (argv[5], NULL, 10) : 1;
+    if (games <= 0 || threads <= 0) {
+	fprintf (stderr, "Usage: %s sweep output [games] [threads]"
+		 " [seed]\n", argv[0]);
+	return 1;
+    }
+    if (! (input = fopen (argv[1], "r"))) {
+	fprintf (stderr, "Cannot open sweep %s\n", argv[1]);
+	return 1;
+    }
+    points = read_sweep (input);
+    fclose (input);
+    if (! points) {
+	fprintf (stderr, "Invalid sweep in %s\n", argv[1]);
+	return 1;
+    }
+    if (! (output = fopen (argv[2], "wb"))
+	|| ! write_header (output, points)) {
+	fprintf (stderr, "Cannot write to %s\n", argv[2]);
+	return 1;
+    }
+
+    /* set up the starting position and the workers' games */
+    start = new_game (BARONIES);
+    start->report_policy = REPORT_NONE;
+    if (! (workers = calloc (threads, sizeof (worker_t)))
+	|| ! (record = malloc (RECORD_SIZE)))
+	fatal_error (FATAL_MEMORY);
+    for (w = 0; w < threads; ++w)
+	workers[w].game = game_clone (start);
+
+    /* play the games at each ruleset, writing each as it finishes */
+    seed_random (&rng, seed);
+    printf ("  point");
+    for (a = 0; a < axis_count; ++a)
+	printf (" %s", rule_name (axes[a].field));
+    printf ("  top land  low land   decided   checksum\n");
+    for (p = 0; p < points; ++p) {
+	point_rules (&rules, p, &rng);
+	if (! set_rules (start, &rules))
+	    fatal_error (FATAL_CONFIG);
+	sweep_point (workers, threads, &total);
+	if (! write_record (output, record, &rules, &total)) {
+	    fprintf (stderr, "Cannot write to %s\n", argv[2]);
+	    return 2;
+	}
+	show_point (p, &rules, &total);
+    }
+
+    /* clean up */
+    for (w = 0; w < threads; ++w)
+	end_game (workers[w].game);
+    end_game (start);
+    free (workers);
+    free (record);
+    if (fclose (output)) {
+	fprintf (stderr, "Cannot write to %s\n", argv[2]);
+	return 2;
+    }
+    return 0;
+}
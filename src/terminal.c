@@ -88,9 +88,9 @@ state_t display_new_game (game_t *game)
     printf ("NEW GAME:\n");
     
     /* display the baronies */
-    for (b = 0; b < BARONIES; ++b)
-	printf ("%d: %s - %s\n", b + 1, game->baronies[b]->name,
-		control_names[game->baronies[b]->control]);
+    for (b = 0; b < game->barony_count; ++b)
+	printf ("%d: %s - %s\n", b + 1, game->baronies[b].name,
+		control_names[game->baronies[b].control]);
     printf ("0: start game\n");
     humans = 0;
 
@@ -103,19 +103,19 @@ state_t display_new_game (game_t *game)
 	input = atoi (text_input);
 
 	/* switch player between human and computer */
-	if (input > 0 && input <= BARONIES) {
+	if (input > 0 && input <= game->barony_count) {
 	    b = input - 1;
-	    if (game->baronies[b]->control == CONTROL_HUMAN) {
-		game->baronies[b]->control = CONTROL_COMPUTER;
+	    if (game->baronies[b].control == CONTROL_HUMAN) {
+		game->baronies[b].control = CONTROL_COMPUTER;
 		humans--;
 	    } else {
-		game->baronies[b]->control = CONTROL_HUMAN;
+		game->baronies[b].control = CONTROL_HUMAN;
 		humans++;
 		if (humans == 1)
 		    player = viewed = b;
 	    }
-	    printf ("%d: %s - %s\n", b + 1, game->baronies[b]->name,
-		    control_names[game->baronies[b]->control]);
+	    printf ("%d: %s - %s\n", b + 1, game->baronies[b].name,
+		    control_names[game->baronies[b].control]);
 	}
 
 	/* warn if starting game without humans */
@@ -158,13 +158,13 @@ state_t display_main_menu (game_t *game)
     printf ("Turn %d\n", game->turn + 1);
 
     /* display the baronies */
-    for (b = 0; b < BARONIES; ++b)
-	if (game->baronies[b]->control == CONTROL_HUMAN)
-	    printf ("%d: %s - %s\n", b + 1, game->baronies[b]->name,
-		    control_names[game->baronies[b]->control]);
+    for (b = 0; b < game->barony_count; ++b)
+	if (game->baronies[b].control == CONTROL_HUMAN)
+	    printf ("%d: %s - %s\n", b + 1, game->baronies[b].name,
+		    control_names[game->baronies[b].control]);
 	else
-	    printf ("   %s - %s\n", game->baronies[b]->name,
-		    control_names[game->baronies[b]->control]);
+	    printf ("   %s - %s\n", game->baronies[b].name,
+		    control_names[game->baronies[b].control]);
     printf ("0: end turn\n");
 
     /* input barony */
@@ -172,12 +172,12 @@ state_t display_main_menu (game_t *game)
 	printf ("Option: ");
 	scanf ("%s", text_input);
 	input = atoi (text_input);
-	if (input > 0 && input <= BARONIES &&
-	    game->baronies[input - 1]->control == CONTROL_HUMAN)
+	if (input > 0 && input <= game->barony_count &&
+	    game->baronies[input - 1].control == CONTROL_HUMAN)
 	    viewed = player = input - 1;
-    } while (input < 0 || input > BARONIES ||
+    } while (input < 0 || input > game->barony_count ||
 	     (input > 0 &&
-	      game->baronies[input - 1]->control != CONTROL_HUMAN));
+	      game->baronies[input - 1].control != CONTROL_HUMAN));
     printf ("\n");
 
     /* return the appropriate display state */
@@ -197,7 +197,7 @@ state_t display_own_barony (game_t *game)
     char text_input[81]; /* text input */
     
     /* display the barony and the menu */
-    display_barony (game->baronies[viewed], game->turn);
+    display_barony (&game->baronies[viewed], game->turn);
     printf ("1: Spend   2: Report   3: Previous   4: Next   0: Done\n");
 
     /* menu loop */
@@ -238,7 +238,7 @@ state_t display_other_barony (game_t *game)
     char text_input[81]; /* text input */
     
     /* display the barony and the menu */
-    display_barony (game->baronies[viewed], game->turn);
+    display_barony (&game->baronies[viewed], game->turn);
     printf ("1: Attack   3: Previous   4: Next   0: Done\n");
 
     /* menu loop */
@@ -280,10 +280,8 @@ state_t display_order (game_t *game)
 	max; /* maximum number of units */
     char text_input[81]; /* text input */
 
-    /* clear out any existing order */
-    if (game->orders[player])
-	free (game->orders[player]);
-    game->orders[player] = new_order (game->baronies[player]);
+    /* replace any existing order */
+    new_order (game, player);
 
     /* input castles */
     max = max_castles_to_buy (game, player);
@@ -292,7 +290,7 @@ state_t display_order (game_t *game)
 	scanf ("%s", text_input);
 	castles = atoi (text_input);
     } while (castles < 0 || castles > max);
-    game->orders[player]->castles = castles;
+    set_order (game, player, castles, 0, 0);
 
     /* input knights */
     max = max_knights_to_buy (game, player);
@@ -301,7 +299,7 @@ state_t display_order (game_t *game)
 	scanf ("%s", text_input);
 	knights = atoi (text_input);
     } while (knights < 0 || knights > max);
-    game->orders[player]->knights = knights;
+    set_order (game, player, castles, knights, 0);
 
     /* input footmen */
     max = max_footmen_to_buy (game, player);
@@ -310,13 +308,11 @@ state_t display_order (game_t *game)
 	scanf ("%s", text_input);
 	footmen = atoi (text_input);
     } while (footmen < 0 || footmen > max);
-    game->orders[player]->footmen = footmen;
+    set_order (game, player, castles, knights, footmen);
 
     /* remove the order if no units were ordered */
-    if (castles + knights + footmen == 0) {
-	free (game->orders[player]);
-	game->orders[player] = NULL;
-    }
+    if (castles + knights + footmen == 0)
+	cancel_order (game, player);
 
     /* return to own barony view */
     printf ("\n");
@@ -335,13 +331,6 @@ state_t display_attack (game_t *game)
 	max; /* maximum force available */
     char text_input[81]; /* text input */
 
-    /* make sure there is an attack to edit/display */
-    if (! game->attacks[player][viewed])
-	game->attacks[player][viewed] =
-	    new_attack (game->baronies[player],
-			game->baronies[viewed],
-			0, 0);
-
     /* input knights */
     max = max_knights_to_send (game, player, viewed);
     do {
@@ -349,7 +338,6 @@ state_t display_attack (game_t *game)
 	scanf ("%s", text_input);
 	knights = atoi (text_input);
     } while (knights < 0 || knights > max);
-    game->attacks[player][viewed]->knights = knights;
 
     /* input footmen */
     max = max_footmen_to_send (game, player, viewed);
@@ -358,14 +346,12 @@ state_t display_attack (game_t *game)
 	scanf ("%s", text_input);
 	footmen = atoi (text_input);
     } while (footmen < 0 || footmen > max);
-    game->attacks[player][viewed]->footmen = footmen;
 
-    /* get rid of attacks with no troops */
-    if (game->attacks[player][viewed]->knights +
-	game->attacks[player][viewed]->footmen == 0) {
-	free (game->attacks[player][viewed]);
-	game->attacks[player][viewed] = NULL;
-    }
+    /* make the attack, or get rid of it if it has no troops */
+    if (knights + footmen)
+	new_attack (game, player, viewed, knights, footmen);
+    else
+	cancel_attack (game, player, viewed);
 
     /* return next state */
     printf ("\n");
@@ -379,11 +365,11 @@ state_t display_attack (game_t *game)
  */
 state_t display_report (game_t *game)
 {
-    int b; /* barony counter */
+    attack_report_t *battle; /* an attack or defence report */
     report_t *report; /* the barony's report */
 
     /* print the report header */
-    printf ("Report on %s barony.\n", game->baronies[player]->name);
+    printf ("Report on %s barony.\n", game->baronies[player].name);
     
     /* return if there is no report */
     if (! (report = game->reports[player])) {
@@ -392,51 +378,51 @@ state_t display_report (game_t *game)
     }
 
     /* report on attacks sent out */
-    for (b = 0; b < BARONIES; ++b)
-	if (report->attacks[b]) {
-	    printf ("You attacked the barony of %s",
-		    report->attacks[b]->target->name);
-	    printf (" with %d knights and %d footmen.\n",
-		    report->attacks[b]->knights_sent,
-		    report->attacks[b]->footmen_sent);
-	    printf ("You took %d land", report->attacks[b]->land_taken);
-	    printf (" and looted %d gold.\n",
-		    report->attacks[b]->gold_looted);
-	    printf ("You took possession of %d castles,",
-		    report->attacks[b]->castles_taken);
-	    printf (" and razed %d,",
-		    report->attacks[b]->castles_razed);
-	    printf (" and slew %d footmen.\n",
-		    report->attacks[b]->footmen_slain);
-	    printf ("You lost %d knights",
-		    report->attacks[b]->knights_lost);
-	    printf (" and %d footmen in the attack.\n",
-		    report->attacks[b]->footmen_lost);
-	}
+    for (battle = report->attacks; battle;
+	 battle = battle->next_attack) {
+	printf ("You attacked the barony of %s",
+		battle->target->name);
+	printf (" with %d knights and %d footmen.\n",
+		battle->knights_sent,
+		battle->footmen_sent);
+	printf ("You took %d land", battle->land_taken);
+	printf (" and looted %d gold.\n",
+		battle->gold_looted);
+	printf ("You took possession of %d castles,",
+		battle->castles_taken);
+	printf (" and razed %d,",
+		battle->castles_razed);
+	printf (" and slew %d footmen.\n",
+		battle->footmen_slain);
+	printf ("You lost %d knights",
+		battle->knights_lost);
+	printf (" and %d footmen in the attack.\n",
+		battle->footmen_lost);
+    }
 
     /* report on defence against attacks sent against us */
-    for (b = 0; b < BARONIES; ++b)
-	if (report->defences[b]) {
-	    printf ("You were attacked by the barony of %s",
-		    report->defences[b]->origin->name);
-	    printf (" with %d knights and %d footmen.\n",
-		    report->defences[b]->knights_sent,
-		    report->defences[b]->footmen_sent);
-	    printf ("They took %d land",
-		    report->defences[b]->land_taken);
-	    printf (" and looted %d gold.\n",
-		    report->defences[b]->gold_looted);
-	    printf ("They took possession of %d castles,",
-		    report->defences[b]->castles_taken);
-	    printf (" and razed %d,",
-		    report->defences[b]->castles_razed);
-	    printf (" and slew %d footmen.\n",
-		    report->defences[b]->footmen_slain);
-	    printf ("You slew %d knights",
-		    report->defences[b]->knights_lost);
-	    printf (" and %d footmen in the attack.\n",
-		    report->defences[b]->footmen_lost);
-	}
+    for (battle = report->defences; battle;
+	 battle = battle->next_defence) {
+	printf ("You were attacked by the barony of %s",
+		battle->origin->name);
+	printf (" with %d knights and %d footmen.\n",
+		battle->knights_sent,
+		battle->footmen_sent);
+	printf ("They took %d land",
+		battle->land_taken);
+	printf (" and looted %d gold.\n",
+		battle->gold_looted);
+	printf ("They took possession of %d castles,",
+		battle->castles_taken);
+	printf (" and razed %d,",
+		battle->castles_razed);
+	printf (" and slew %d footmen.\n",
+		battle->footmen_slain);
+	printf ("You slew %d knights",
+		battle->knights_lost);
+	printf (" and %d footmen in the attack.\n",
+		battle->footmen_lost);
+    }
 
     /* population migration and tax income */
     if (report->migration > 0)
@@ -502,8 +488,8 @@ state_t display_end_turn (game_t *game)
 
     /* if one human player, go straight to their barony afterwards */
     if (humans == 1)
-	for (b = 0; b < BARONIES; ++b)
-	    if (game->baronies[b]->control == CONTROL_HUMAN) {
+	for (b = 0; b < game->barony_count; ++b)
+	    if (game->baronies[b].control == CONTROL_HUMAN) {
 		player = viewed = b;
 		return game->turn == 11 ?
 		    DISPLAY_END_GAME :
@@ -523,27 +509,28 @@ state_t display_end_turn (game_t *game)
  */
 state_t display_end_game (game_t *game)
 {
-    int l, /* last rank displayed */
-	r, /* ranking counter */
+    int l, /* last ranking displayed */
+	r, /* rank counter */
 	b, /* barony counter */
 	input; /* user input */
     char text_input[81]; /* text input */
+    rank_t *ranks; /* the baronies in rank order */
 
     /* title */
     printf ("END GAME\n");
     /* show the baronies in rank order */
     l = 0;
-    for (r = 1; r <= BARONIES; ++r)
-	for (b = 0; b < BARONIES; ++b)
-	    if (game->baronies[b]->ranking == r) {
-		if (l == r)
-		    printf ("   %s (key %d)\n",
-			    game->baronies[b]->name, b + 1);
-		else
-		    printf ("%d  %s (key %d)\n", r,
-			    game->baronies[b]->name, b + 1);
-		l = r;
-	    }
+    ranks = get_rankings (game);
+    for (r = 0; r < game->barony_count; ++r) {
+	b = ranks[r].barony;
+	if (l == game->baronies[b].ranking)
+	    printf ("   %s (key %d)\n",
+		    game->baronies[b].name, b + 1);
+	else
+	    printf ("%d  %s (key %d)\n", game->baronies[b].ranking,
+		    game->baronies[b].name, b + 1);
+	l = game->baronies[b].ranking;
+    }
     printf ("Type 0 to quit\n");
 
     /* allow inspection of a barony */
@@ -554,7 +541,7 @@ state_t display_end_game (game_t *game)
 	if (input == 0) {
 	    printf ("\n");
 	    return DISPLAY_QUIT;
-	} else if (input > 0 && input <= BARONIES) {
+	} else if (input > 0 && input <= game->barony_count) {
 	    printf ("\n");
 	    viewed = input - 1;
 	    return DISPLAY_END_BARONY;
@@ -569,7 +556,7 @@ state_t display_end_game (game_t *game)
  */
 state_t display_end_barony (game_t *game)
 {
-    display_barony (game->baronies[viewed], 11);
+    display_barony (&game->baronies[viewed], 11);
     printf ("\n");
     return DISPLAY_END_GAME;
 }
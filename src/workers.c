@@ -0,0 +1,272 @@
+/*======================================================================
+ * Anarchic Kingdom
+ * A light strategy game set in medieval times.
+ * Copyright (C) Damian Gareth Walker 2021.
+ *
+ * Worker Pool Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Included Headers.
+ */
+
+/* standard C headers */
+#include <stdlib.h>
+
+/* POSIX headers, where there are threads */
+#if defined (__unix__) || defined (__APPLE__)
+#include <unistd.h>
+#endif
+#if defined (_POSIX_THREADS) && _POSIX_THREADS > 0
+#define WORKER_THREADS
+#include <pthread.h>
+#endif
+
+/* project headers */
+#include "workers.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* typedefs */
+typedef struct helper helper_t;
+
+/** @struct helper is a thread working for a pool. */
+struct helper {
+
+    /** @var pool is the pool the thread works for. */
+    workers_t *pool;
+
+    /** @var id is the thread's place among the workers. */
+    int id;
+
+#ifdef WORKER_THREADS
+    /** @var thread is the POSIX thread. */
+    pthread_t thread;
+#endif
+
+};
+
+/** @struct workers is a pool of worker threads. */
+struct workers {
+
+    /** @var count is the number of workers, counting the caller. */
+    int count;
+
+    /** @var helpers are the threads beyond the caller. */
+    helper_t *helpers;
+
+#ifdef WORKER_THREADS
+    /** @var lock guards the rest of the pool. */
+    pthread_mutex_t lock;
+
+    /** @var start is signalled when there is work or a stop. */
+    pthread_cond_t start;
+
+    /** @var done is signalled when the last helper finishes. */
+    pthread_cond_t done;
+#endif
+
+    /** @var round counts the pieces of work handed out. */
+    unsigned long int round;
+
+    /** @var busy is the number of helpers still working. */
+    int busy;
+
+    /** @var stop is 1 when the helpers are to finish. */
+    int stop;
+
+    /** @var active is the number of workers in the current work. */
+    int active;
+
+    /** @var work is the current work. */
+    work_t work;
+
+    /** @var context is passed to the current work. */
+    void *context;
+
+    /** @var items is the number of items in the current work. */
+    int items;
+
+};
+
+/*----------------------------------------------------------------------
+ * Level 1 Private Functions.
+ */
+
+#ifdef WORKER_THREADS
+/**
+ * Do one worker's share of the current work.
+ * @param pool is the pool.
+ * @param id is the worker's place among the active workers.
+ */
+static void do_share (workers_t *pool, int id)
+{
+    int first, /* first item of the share */
+	last; /* item after the share */
+    first = (int) ((long int) pool->items * id / pool->active);
+    last = (int) ((long int) pool->items * (id + 1) / pool->active);
+    if (first < last)
+	pool->work (pool->context, first, last);
+}
+
+/**
+ * Helper thread: wait for work, do a share of it, and repeat until
+ * told to stop.
+ * @param arg points to the helper.
+ * @return NULL.
+ */
+static void *help (void *arg)
+{
+    helper_t *helper; /* this helper */
+    workers_t *pool; /* the pool it works for */
+    unsigned long int seen; /* the last round of work seen */
+    helper = arg;
+    pool = helper->pool;
+    seen = 0;
+    pthread_mutex_lock (&pool->lock);
+    for (;;) {
+	while (pool->round == seen && ! pool->stop)
+	    pthread_cond_wait (&pool->start, &pool->lock);
+	if (pool->stop)
+	    break;
+	seen = pool->round;
+	if (helper->id < pool->active) {
+	    pthread_mutex_unlock (&pool->lock);
+	    do_share (pool, helper->id);
+	    pthread_mutex_lock (&pool->lock);
+	}
+	if (--pool->busy == 0)
+	    pthread_cond_signal (&pool->done);
+    }
+    pthread_mutex_unlock (&pool->lock);
+    return NULL;
+}
+#endif
+
+/*----------------------------------------------------------------------
+ * Public Functions.
+ */
+
+/**
+ * Create a worker pool.
+ * @param count is the number of workers wanted, counting the caller.
+ * @return the new pool.
+ */
+workers_t *new_workers (int count)
+{
+    workers_t *pool; /* the pool to return */
+#ifdef WORKER_THREADS
+    int h; /* helper counter */
+#endif
+
+    /* allocate the pool */
+    if (! (pool = malloc (sizeof (workers_t))))
+	fatal_error (FATAL_MEMORY);
+#ifndef WORKER_THREADS
+    count = 1;
+#endif
+    pool->count = count > 1 ? count : 1;
+    pool->round = 0;
+    pool->busy = pool->stop = 0;
+    pool->helpers = NULL;
+    if (pool->count == 1)
+	return pool;
+
+    /* start the helpers */
+#ifdef WORKER_THREADS
+    if (! (pool->helpers = malloc ((pool->count - 1)
+				   * sizeof (helper_t))))
+	fatal_error (FATAL_MEMORY);
+    pthread_mutex_init (&pool->lock, NULL);
+    pthread_cond_init (&pool->start, NULL);
+    pthread_cond_init (&pool->done, NULL);
+    for (h = 0; h < pool->count - 1; ++h) {
+	pool->helpers[h].pool = pool;
+	pool->helpers[h].id = h + 1;
+	if (pthread_create (&pool->helpers[h].thread, NULL, help,
+			    &pool->helpers[h]))
+	    fatal_error (FATAL_MEMORY);
+    }
+#endif
+    return pool;
+}
+
+/**
+ * Get the number of workers in a pool.
+ * @param workers is the pool.
+ * @return the number of workers, counting the caller.
+ */
+int worker_count (workers_t *workers)
+{
+    return workers->count;
+}
+
+/**
+ * Do some work on a range of items, and wait for it to finish.
+ * @param workers is the pool.
+ * @param work is the function to do the work.
+ * @param context is passed to the function.
+ * @param items is the number of items.
+ * @param least is the fewest items worth giving a worker.
+ */
+void run_workers (workers_t *workers, work_t work, void *context,
+		  int items, int least)
+{
+    /* set out the work, sharing it among as many as are worth it */
+    workers->work = work;
+    workers->context = context;
+    workers->items = items;
+    workers->active = least > 0 ? items / least : items;
+    if (workers->active > workers->count)
+	workers->active = workers->count;
+
+    /* do small work in line */
+    if (workers->active <= 1) {
+	if (items > 0)
+	    work (context, 0, items);
+	return;
+    }
+
+    /* otherwise wake the helpers, do the first share, and wait */
+#ifdef WORKER_THREADS
+    pthread_mutex_lock (&workers->lock);
+    ++workers->round;
+    workers->busy = workers->count - 1;
+    pthread_cond_broadcast (&workers->start);
+    pthread_mutex_unlock (&workers->lock);
+    do_share (workers, 0);
+    pthread_mutex_lock (&workers->lock);
+    while (workers->busy)
+	pthread_cond_wait (&workers->done, &workers->lock);
+    pthread_mutex_unlock (&workers->lock);
+#endif
+}
+
+/**
+ * Stop the workers of a pool and free it.
+ * @param workers is the pool.
+ */
+void end_workers (workers_t *workers)
+{
+#ifdef WORKER_THREADS
+    int h; /* helper counter */
+#endif
+    if (workers->count > 1) {
+#ifdef WORKER_THREADS
+	pthread_mutex_lock (&workers->lock);
+	workers->stop = 1;
+	pthread_cond_broadcast (&workers->start);
+	pthread_mutex_unlock (&workers->lock);
+	for (h = 0; h < workers->count - 1; ++h)
+	    pthread_join (workers->helpers[h].thread, NULL);
+	pthread_mutex_destroy (&workers->lock);
+	pthread_cond_destroy (&workers->start);
+	pthread_cond_destroy (&workers->done);
+#endif
+	free (workers->helpers);
+    }
+    free (workers);
+}